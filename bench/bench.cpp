@@ -0,0 +1,1097 @@
+// Benchmarks comparing C-API wrappers taking a `std::string_view`, which must
+// always copy into a temporary `std::string`, against wrappers taking a
+// `bev::string_view`, which can skip the copy whenever `is_cstring()` holds.
+//
+// Every wrapper benchmark takes two arguments: the kind of input the view was
+// created from (see `input_kind`), and the length of the path in bytes.
+
+#include <bev/string_view.hpp>
+#include <bev/cached_string_view.hpp>
+#include <bev/ci_string_view.hpp>
+#include <bev/cstring_batch.hpp>
+#include <bev/incremental_searcher.hpp>
+#include <bev/multi_searcher.hpp>
+#include <bev/offset_view.hpp>
+#include <bev/parallel.hpp>
+#include <bev/parse.hpp>
+#include <bev/searcher.hpp>
+#include <bev/sorted_view_set.hpp>
+#include <bev/split.hpp>
+#include <bev/string_interner.hpp>
+#include <bev/utf8.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// ---- Inputs ----
+
+enum class input_kind {
+  literal,       // from a `const char*`, null-terminated
+  string,        // from a `std::string`, null-terminated
+  substr,        // a tail `substr()` of a `std::string`, null-terminated
+  remove_suffix, // a `std::string` after `remove_suffix(1)`, not terminated
+};
+
+const char* kind_name(input_kind kind)
+{
+  switch (kind) {
+  case input_kind::literal: return "literal";
+  case input_kind::string: return "string";
+  case input_kind::substr: return "substr";
+  case input_kind::remove_suffix: return "remove_suffix";
+  }
+  return "";
+}
+
+// Number of bytes dropped from the front of the storage for `substr` inputs.
+constexpr size_t substr_offset = 8;
+
+// Builds a path of exactly `len` bytes that does not exist, so that the
+// syscall benchmarks measure the path lookup rather than any actual I/O.
+std::string make_path(size_t len)
+{
+  static const char component[] = "/svbench";
+  std::string result;
+  result.reserve(len);
+  while (result.size() < len)
+    result.push_back(component[result.size() % (sizeof(component) - 1)]);
+  return result;
+}
+
+std::string make_storage(input_kind kind, size_t len)
+{
+  switch (kind) {
+  case input_kind::substr: return make_path(len + substr_offset);
+  case input_kind::remove_suffix: return make_path(len + 1);
+  default: return make_path(len);
+  }
+}
+
+// Creates a view of exactly `len` bytes into `storage`, which must have been
+// created by `make_storage()` with the same `kind`.
+template<typename View>
+View make_view(input_kind kind, const std::string& storage)
+{
+  switch (kind) {
+  case input_kind::literal:
+    return View{storage.c_str()};
+  case input_kind::string:
+    return View{storage};
+  case input_kind::substr:
+    return View{storage}.substr(substr_offset);
+  case input_kind::remove_suffix: {
+    View view{storage};
+    view.remove_suffix(1);
+    return view;
+  }
+  }
+  return View{};
+}
+
+void wrapper_args(benchmark::internal::Benchmark* b)
+{
+  b->ArgNames({"kind", "len"});
+  b->ArgsProduct({
+    {int(input_kind::literal), int(input_kind::string),
+     int(input_kind::substr), int(input_kind::remove_suffix)},
+    {8, 15, 16, 64, 256, 1024, 4000}});
+}
+
+// ---- Wrappers ----
+//
+// Each wrapper has a `std` flavour that always copies, as recommended for
+// `std::string_view`, and a `bev` flavour that follows the pattern from the
+// README.
+
+// Stands in for an arbitrary C function, so that the wrapper benchmarks can
+// isolate the cost of producing the `const char*` from the cost of the call.
+[[gnu::noinline]] int c_api(const char* str)
+{
+  benchmark::DoNotOptimize(str);
+  return str[0];
+}
+
+struct std_c_api {
+  using view_type = std::string_view;
+  static int call(view_type sv)
+  { return c_api(std::string{sv}.c_str()); }
+};
+
+struct bev_c_api {
+  using view_type = bev::string_view;
+  static int call(view_type sv)
+  {
+    if (sv.is_cstring())
+      return c_api(sv.data());
+    return c_api(std::string(sv.data(), sv.size()).c_str());
+  }
+};
+
+// Same as `bev_c_api`, but using `c_str_or_copy()`, which copies into a stack
+// buffer instead of a heap-allocated `std::string`.
+struct bev_c_api_arg {
+  using view_type = bev::string_view;
+  static int call(view_type sv)
+  { return c_api(sv.c_str_or_copy().c_str()); }
+};
+
+int close_if_open(int fd)
+{
+  if (fd >= 0)
+    ::close(fd);
+  return fd;
+}
+
+struct std_open {
+  using view_type = std::string_view;
+  static int call(view_type sv)
+  { return close_if_open(::open(std::string{sv}.c_str(), O_RDONLY)); }
+};
+
+struct bev_open {
+  using view_type = bev::string_view;
+  static int call(view_type sv)
+  {
+    if (sv.is_cstring())
+      return close_if_open(::open(sv.data(), O_RDONLY));
+    const std::string copy(sv.data(), sv.size());
+    return close_if_open(::open(copy.c_str(), O_RDONLY));
+  }
+};
+
+struct std_stat {
+  using view_type = std::string_view;
+  static int call(view_type sv)
+  {
+    struct ::stat st;
+    return ::stat(std::string{sv}.c_str(), &st);
+  }
+};
+
+struct bev_stat {
+  using view_type = bev::string_view;
+  static int call(view_type sv)
+  {
+    struct ::stat st;
+    if (sv.is_cstring())
+      return ::stat(sv.data(), &st);
+    return ::stat(std::string(sv.data(), sv.size()).c_str(), &st);
+  }
+};
+
+struct std_getenv {
+  using view_type = std::string_view;
+  static int call(view_type sv)
+  { return std::getenv(std::string{sv}.c_str()) != nullptr; }
+};
+
+struct bev_getenv {
+  using view_type = bev::string_view;
+  static int call(view_type sv)
+  {
+    if (sv.is_cstring())
+      return std::getenv(sv.data()) != nullptr;
+    return std::getenv(std::string(sv.data(), sv.size()).c_str()) != nullptr;
+  }
+};
+
+template<typename Wrapper>
+void BM_wrapper(benchmark::State& state)
+{
+  using view_type = typename Wrapper::view_type;
+  const auto kind = static_cast<input_kind>(state.range(0));
+  const auto len = static_cast<size_t>(state.range(1));
+  const std::string storage = make_storage(kind, len);
+  const view_type path = make_view<view_type>(kind, storage);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(Wrapper::call(path));
+
+  state.SetLabel(kind_name(kind));
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(len));
+}
+
+BENCHMARK_TEMPLATE(BM_wrapper, std_c_api)->Apply(wrapper_args);
+BENCHMARK_TEMPLATE(BM_wrapper, bev_c_api)->Apply(wrapper_args);
+BENCHMARK_TEMPLATE(BM_wrapper, bev_c_api_arg)->Apply(wrapper_args);
+BENCHMARK_TEMPLATE(BM_wrapper, std_getenv)->Apply(wrapper_args);
+BENCHMARK_TEMPLATE(BM_wrapper, bev_getenv)->Apply(wrapper_args);
+BENCHMARK_TEMPLATE(BM_wrapper, std_stat)->Apply(wrapper_args);
+BENCHMARK_TEMPLATE(BM_wrapper, bev_stat)->Apply(wrapper_args);
+BENCHMARK_TEMPLATE(BM_wrapper, std_open)->Apply(wrapper_args);
+BENCHMARK_TEMPLATE(BM_wrapper, bev_open)->Apply(wrapper_args);
+
+// 1024 paths of 64 bytes, every other one not null-terminated, passed to
+// the C function one by one: either copying each of those that need it into
+// a `std::string`, or resolving all of them with a reused `cstring_batch`.
+template<bool Batch>
+void BM_cstring_batch(benchmark::State& state)
+{
+  std::vector<std::string> storage;
+  std::vector<bev::string_view> paths;
+  for (size_t i = 0; i < 1024; ++i)
+    storage.push_back(make_storage(input_kind::remove_suffix, 64));
+  for (size_t i = 0; i < storage.size(); ++i)
+    paths.push_back(make_view<bev::string_view>(
+        i % 2 ? input_kind::remove_suffix : input_kind::string, storage[i]));
+  bev::cstring_batch batch;
+  for (auto _ : state) {
+    int result = 0;
+    if constexpr (Batch) {
+      const char* const* strs = batch.assign(paths);
+      for (size_t i = 0; i < paths.size(); ++i)
+        result += c_api(strs[i]);
+    } else {
+      for (bev::string_view path : paths)
+        result += bev_c_api::call(path);
+    }
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) *
+                          int64_t(paths.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_cstring_batch, false);
+BENCHMARK_TEMPLATE(BM_cstring_batch, true);
+
+// ---- Cost of the safederef bit ----
+//
+// `bev::string_view` has to mask out the safederef bit every time the length
+// is read. These benchmarks run the same tight loops over `std::string_view`
+// and `bev::string_view` to measure what that costs.
+
+// Strings of varying lengths, so that the loops cannot be specialized for a
+// single size. The views are created from `std::string`, so for
+// `bev::string_view` the safederef bit is set on every one of them.
+const std::vector<std::string>& view_storage()
+{
+  static const std::vector<std::string> storage = [] {
+    std::vector<std::string> result;
+    for (size_t i = 0; i < 1024; ++i)
+      result.push_back(make_path(1 + (i * 7) % 61));
+    return result;
+  }();
+  return storage;
+}
+
+template<typename View>
+std::vector<View> make_views()
+{
+  std::vector<View> result;
+  for (const auto& s : view_storage())
+    result.push_back(View{s});
+  return result;
+}
+
+template<typename View>
+void BM_sum_size(benchmark::State& state)
+{
+  const auto views = make_views<View>();
+  for (auto _ : state) {
+    size_t total = 0;
+    for (const auto& sv : views)
+      total += sv.size();
+    benchmark::DoNotOptimize(total);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(views.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_sum_size, std::string_view);
+BENCHMARK_TEMPLATE(BM_sum_size, bev::string_view);
+
+template<typename View>
+void BM_sum_length(benchmark::State& state)
+{
+  const auto views = make_views<View>();
+  for (auto _ : state) {
+    size_t total = 0;
+    for (const auto& sv : views)
+      total += sv.length();
+    benchmark::DoNotOptimize(total);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(views.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_sum_length, std::string_view);
+BENCHMARK_TEMPLATE(BM_sum_length, bev::string_view);
+
+template<typename View>
+void BM_iterate_end(benchmark::State& state)
+{
+  const auto views = make_views<View>();
+  for (auto _ : state) {
+    unsigned total = 0;
+    for (const auto& sv : views)
+      for (auto it = sv.begin(); it != sv.end(); ++it)
+        total += static_cast<unsigned char>(*it);
+    benchmark::DoNotOptimize(total);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(views.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_iterate_end, std::string_view);
+BENCHMARK_TEMPLATE(BM_iterate_end, bev::string_view);
+
+template<typename View>
+void BM_index_loop(benchmark::State& state)
+{
+  const auto views = make_views<View>();
+  for (auto _ : state) {
+    unsigned total = 0;
+    for (const auto& sv : views)
+      for (size_t i = 0; i < sv.size(); ++i)
+        total += static_cast<unsigned char>(sv[i]);
+    benchmark::DoNotOptimize(total);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(views.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_index_loop, std::string_view);
+BENCHMARK_TEMPLATE(BM_index_loop, bev::string_view);
+
+// Views of the first 4000 bytes of 4096 strings of 4 KiB, of which only the
+// first byte is read besides `is_cstring()`. The terminator check of
+// `bev::string_view` loads the byte after the view from another cache line,
+// `bev::cached_string_view` did so once when it was created.
+template<typename View>
+void BM_is_cstring(benchmark::State& state)
+{
+  static const std::vector<std::string> storage(4096, make_path(4 << 10));
+  std::vector<View> views;
+  for (const std::string& s : storage)
+    views.push_back(View{bev::string_view{s}.substr(0, 4000)});
+  for (auto _ : state) {
+    size_t total = 0;
+    for (const View& sv : views)
+      total += static_cast<size_t>(sv[0]) + sv.is_cstring();
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(views.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_is_cstring, bev::string_view);
+BENCHMARK_TEMPLATE(BM_is_cstring, bev::cached_string_view);
+
+// ---- Searching ----
+
+// A haystack of `len` bytes of HTTP-header-like text that contains the needle
+// only at the very end.
+std::string make_haystack(size_t len, const std::string& needle)
+{
+  static const char line[] = "Header-Name: some value\r\n";
+  std::string result;
+  while (result.size() + needle.size() < len)
+    result.push_back(line[result.size() % (sizeof(line) - 1)]);
+  return result + needle;
+}
+
+template<typename View>
+void BM_find(benchmark::State& state)
+{
+  const std::string needle = "\r\n\r\n";
+  const std::string storage =
+      make_haystack(static_cast<size_t>(state.range(0)), needle);
+  const View hay{storage};
+  const View sv{needle};
+  for (auto _ : state)
+    benchmark::DoNotOptimize(hay.find(sv));
+  state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_find, std::string_view)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_find, bev::string_view)->Range(64, 1 << 20);
+
+// A haystack of `len` bytes that contains the needle only at the very start,
+// so that reverse searches have to scan all of it.
+template<typename View>
+void BM_rfind(benchmark::State& state)
+{
+  const std::string needle = "\r\n\r\n";
+  std::string storage =
+      make_haystack(static_cast<size_t>(state.range(0)), needle);
+  storage.replace(0, needle.size(), needle);
+  storage.replace(storage.size() - needle.size(), needle.size(), "xxxx");
+  const View hay{storage};
+  const View sv{needle};
+  for (auto _ : state)
+    benchmark::DoNotOptimize(hay.rfind(sv));
+  state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_rfind, std::string_view)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_rfind, bev::string_view)->Range(64, 1 << 20);
+
+template<typename View>
+void BM_find_first_of(benchmark::State& state)
+{
+  const std::string storage =
+      make_haystack(static_cast<size_t>(state.range(0)), ";");
+  const View hay{storage};
+  const View delims{",;"};
+  for (auto _ : state)
+    benchmark::DoNotOptimize(hay.find_first_of(delims));
+  state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_find_first_of, std::string_view)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_find_first_of, bev::string_view)->Range(64, 1 << 20);
+
+// Pseudo-random printable text of `len` bytes, with a needle of `range(0)`
+// bytes at the end, searched for with `find()` or a precomputed searcher.
+std::string make_printable(size_t len, uint32_t seed)
+{
+  std::string result;
+  for (size_t i = 0; i < len; ++i) {
+    seed = seed * 1664525u + 1013904223u;
+    result.push_back(static_cast<char>(' ' + (seed >> 24) % 95));
+  }
+  return result;
+}
+
+template<bool Precomputed>
+void BM_find_long_needle(benchmark::State& state)
+{
+  const std::string needle =
+      make_printable(static_cast<size_t>(state.range(0)), 1);
+  const std::string storage = make_printable(64 << 10, 2) + needle;
+  const bev::string_view hay{storage};
+  const bev::string_view sv{needle};
+  const bev::searcher searcher{sv};
+  for (auto _ : state) {
+    if constexpr (Precomputed)
+      benchmark::DoNotOptimize(hay.find(searcher));
+    else
+      benchmark::DoNotOptimize(hay.find(sv));
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) *
+                          int64_t(storage.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_find_long_needle, false)->Range(16, 1024);
+BENCHMARK_TEMPLATE(BM_find_long_needle, true)->Range(16, 1024);
+
+// `range(0)` patterns of 6 to 13 bytes searched for in 64 KiB of printable
+// text that contains none of them, either with one `find()` per pattern or
+// with a single pass of a `multi_searcher`.
+template<bool Multi>
+void BM_find_patterns(benchmark::State& state)
+{
+  std::vector<std::string> storage;
+  for (int64_t i = 0; i < state.range(0); ++i)
+    storage.push_back(
+        make_printable(6 + static_cast<size_t>(i) % 8, 100 + uint32_t(i)));
+  const std::vector<bev::string_view> patterns(storage.begin(), storage.end());
+  const bev::multi_searcher searcher{patterns};
+  const std::string storage_hay = make_printable(64 << 10, 3);
+  const bev::string_view hay{storage_hay};
+  for (auto _ : state) {
+    if constexpr (Multi) {
+      benchmark::DoNotOptimize(searcher.contains_any(hay));
+    } else {
+      bool found = false;
+      for (bev::string_view p : patterns)
+        found |= hay.find(p) != bev::string_view::npos;
+      benchmark::DoNotOptimize(found);
+    }
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) *
+                          int64_t(storage_hay.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_find_patterns, false)->Arg(4)->Arg(16)->Arg(32)->Arg(256);
+BENCHMARK_TEMPLATE(BM_find_patterns, true)->Arg(4)->Arg(16)->Arg(32)->Arg(256);
+
+// Splitting the haystack into its header lines and fields, either with a
+// loop over `find_first_of()` and `substr()` or with `bev::split()`.
+template<bool Range>
+void BM_split(benchmark::State& state)
+{
+  const std::string storage =
+      make_haystack(static_cast<size_t>(state.range(0)), "\r\n");
+  const bev::string_view hay{storage};
+  static constexpr bev::char_set delims{" :\r\n"};
+  for (auto _ : state) {
+    size_t tokens = 0;
+    if constexpr (Range) {
+      for (bev::string_view token : bev::split(hay, delims, bev::skip_empty))
+        tokens += token.size();
+    } else {
+      for (size_t pos = 0; pos < hay.size();) {
+        const size_t end = std::min(hay.find_first_of(delims, pos), hay.size());
+        tokens += hay.substr(pos, end - pos).size();
+        pos = end + 1;
+      }
+    }
+    benchmark::DoNotOptimize(tokens);
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_split, false)->Range(64, 64 << 10);
+BENCHMARK_TEMPLATE(BM_split, true)->Range(64, 64 << 10);
+
+// A request head of `len` bytes that arrives in packets of 16 bytes, and a
+// search for its end after every packet: either with `find()` over all of
+// the data received so far, or with an incremental searcher.
+void BM_stream_rescan(benchmark::State& state)
+{
+  const std::string needle = "\r\n\r\n";
+  const std::string storage =
+      make_haystack(static_cast<size_t>(state.range(0)), needle);
+  for (auto _ : state) {
+    size_t pos = bev::string_view::npos;
+    for (size_t received = 16; pos == bev::string_view::npos; received += 16)
+      pos = bev::string_view{storage}
+                .substr(0, std::min(received, storage.size()))
+                .find(bev::string_view{needle});
+    benchmark::DoNotOptimize(pos);
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+void BM_stream_incremental(benchmark::State& state)
+{
+  const std::string needle = "\r\n\r\n";
+  const std::string storage =
+      make_haystack(static_cast<size_t>(state.range(0)), needle);
+  for (auto _ : state) {
+    bev::incremental_searcher searcher{bev::string_view{needle}};
+    size_t pos = bev::string_view::npos;
+    for (size_t i = 0; pos == bev::string_view::npos; i += 16)
+      pos = searcher.feed(bev::string_view{storage}.substr(i, 16));
+    benchmark::DoNotOptimize(pos);
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(BM_stream_rescan)->Range(256, 64 << 10);
+BENCHMARK(BM_stream_incremental)->Range(256, 64 << 10);
+
+// A 64 MiB log, searched for a needle at its end and counted for line
+// breaks, either sequentially or with `bev::parallel` on all cores.
+const std::string& big_log()
+{
+  static const std::string log = make_haystack(64 << 20, "status=500\r\n");
+  return log;
+}
+
+template<bool Parallel>
+void BM_find_big(benchmark::State& state)
+{
+  const bev::string_view hay{big_log()};
+  const bev::string_view needle{"status=500"};
+  const bev::parallel::thread_executor pool;
+  for (auto _ : state) {
+    if constexpr (Parallel)
+      benchmark::DoNotOptimize(bev::parallel::find(hay, needle, pool));
+    else
+      benchmark::DoNotOptimize(hay.find(needle));
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) *
+                          int64_t(hay.size()));
+}
+
+template<bool Parallel>
+void BM_count_lines(benchmark::State& state)
+{
+  const bev::string_view hay{big_log()};
+  const bev::parallel::thread_executor pool;
+  for (auto _ : state) {
+    if constexpr (Parallel)
+      benchmark::DoNotOptimize(bev::parallel::count(hay, '\n', pool));
+    else
+      benchmark::DoNotOptimize(
+          bev::parallel::count(hay, '\n', bev::parallel::thread_executor{1}));
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) *
+                          int64_t(hay.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_find_big, false)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_find_big, true)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_count_lines, false)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_count_lines, true)->UseRealTime();
+
+// ---- Comparison ----
+
+// Two equal keys of `len` bytes, compared for equality. The keys live in
+// separate buffers, so that the pointer comparison can not short-circuit.
+template<typename View>
+void BM_equal(benchmark::State& state)
+{
+  const std::string a = make_path(static_cast<size_t>(state.range(0)));
+  const std::string b = a;
+  const View x{a};
+  const View y{b};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(x);
+    benchmark::DoNotOptimize(x == y);
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_equal, std::string_view)
+    ->RangeMultiplier(2)->Range(4, 4096);
+BENCHMARK_TEMPLATE(BM_equal, bev::string_view)
+    ->RangeMultiplier(2)->Range(4, 4096);
+
+// Keys of 24 bytes that differ in the first byte.
+template<typename View>
+void BM_not_equal(benchmark::State& state)
+{
+  const std::string a = make_path(24);
+  std::string b = a;
+  b[0] ^= 1;
+  const View x{a};
+  const View y{b};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(x);
+    benchmark::DoNotOptimize(x == y);
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_not_equal, std::string_view);
+BENCHMARK_TEMPLATE(BM_not_equal, bev::string_view);
+
+// ---- Hashing ----
+
+struct std_hash {
+  using view_type = std::string_view;
+  size_t operator()(view_type sv) const { return std::hash<view_type>{}(sv); }
+};
+
+template<typename Algorithm>
+struct bev_hash {
+  using view_type = bev::string_view;
+  size_t operator()(view_type sv) const { return bev::hash<Algorithm>{}(sv); }
+};
+
+template<typename Hasher>
+void BM_hash(benchmark::State& state)
+{
+  using view_type = typename Hasher::view_type;
+  const std::string storage = make_path(static_cast<size_t>(state.range(0)));
+  const view_type sv{storage};
+  for (auto _ : state)
+    benchmark::DoNotOptimize(Hasher{}(sv));
+  state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_hash, std_hash)->RangeMultiplier(4)->Range(4, 4096);
+BENCHMARK_TEMPLATE(BM_hash, bev_hash<bev::murmur2>)
+    ->RangeMultiplier(4)->Range(4, 4096);
+BENCHMARK_TEMPLATE(BM_hash, bev_hash<bev::wyhash>)
+    ->RangeMultiplier(4)->Range(4, 4096);
+
+// ---- Case-insensitive lookup ----
+
+// HTTP header names as they appear on the wire, looked up in a table of
+// known headers either by lowercasing them into a `std::string` first or
+// with a `bev::ci_string_view` key.
+const char* const header_names[] = {
+  "Host", "User-Agent", "Accept", "Accept-Encoding", "Accept-Language",
+  "Content-Type", "Content-Length", "Connection", "Cookie", "Referer",
+  "Cache-Control", "If-None-Match", "If-Modified-Since", "Authorization",
+  "X-Forwarded-For", "X-Request-Id", "Upgrade-Insecure-Requests", "DNT",
+};
+
+template<bool Ci>
+void BM_header_lookup(benchmark::State& state)
+{
+  std::vector<std::string> stream;
+  for (int i = 0; i < 1024; ++i) {
+    std::string name = header_names[(i * 7) % std::size(header_names)];
+    if (i % 3 == 0)
+      for (char& c : name)
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    stream.push_back(name);
+  }
+  std::unordered_map<bev::ci_string_view, int> ci_table;
+  std::unordered_map<std::string, int> table;
+  int index = 0;
+  for (const char* name : header_names) {
+    ci_table.emplace(name, index);
+    std::string lower = name;
+    for (char& c : lower)
+      c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    table.emplace(lower, index++);
+  }
+  for (auto _ : state) {
+    for (const std::string& name : stream) {
+      if constexpr (Ci) {
+        benchmark::DoNotOptimize(ci_table.find(bev::ci_string_view{name}));
+      } else {
+        std::string lower = name;
+        for (char& c : lower)
+          c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        benchmark::DoNotOptimize(table.find(lower));
+      }
+    }
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) *
+                          int64_t(stream.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_header_lookup, false);
+BENCHMARK_TEMPLATE(BM_header_lookup, true);
+
+// Case-insensitive equality of two keys of `len` bytes that differ in case
+// only, against lowercasing both into `std::string`s.
+template<bool Ci>
+void BM_ci_equal(benchmark::State& state)
+{
+  const std::string a = make_path(static_cast<size_t>(state.range(0)));
+  std::string b = a;
+  for (char& c : b)
+    c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a);
+    if constexpr (Ci) {
+      benchmark::DoNotOptimize(bev::ci_string_view{a} == bev::ci_string_view{b});
+    } else {
+      std::string x = a, y = b;
+      for (char& c : x)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+      for (char& c : y)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+      benchmark::DoNotOptimize(x == y);
+    }
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_ci_equal, false)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK_TEMPLATE(BM_ci_equal, true)->RangeMultiplier(4)->Range(16, 4096);
+
+// ---- UTF-8 ----
+
+// 64 KiB of text, either plain ASCII or with a two or three byte sequence
+// after every 8 ASCII characters on average, validated one code point at a
+// time or with `bev::utf8::validate()`.
+const std::string& utf8_text(bool ascii)
+{
+  static std::string texts[2];
+  std::string& text = texts[ascii];
+  if (text.empty()) {
+    uint32_t x = 1;
+    while (text.size() < (64 << 10)) {
+      x = x * 1664525u + 1013904223u;
+      if (ascii || (x >> 24) % 9 != 0)
+        text.push_back(static_cast<char>('a' + (x >> 16) % 26));
+      else if ((x >> 16) % 2)
+        text += "\xc3\xa9";
+      else
+        text += "\xe2\x82\xac";
+    }
+  }
+  return text;
+}
+
+template<bool Bev>
+void BM_utf8_validate(benchmark::State& state)
+{
+  const std::string& text = utf8_text(state.range(0) != 0);
+  const bev::string_view sv{text};
+  for (auto _ : state) {
+    if constexpr (Bev) {
+      benchmark::DoNotOptimize(bev::utf8::validate(sv));
+    } else {
+      bool valid = true;
+      char32_t cp;
+      for (size_t i = 0, len; valid && i < sv.size(); i += len) {
+        len = bev::detail::decode_utf8(sv.data() + i, sv.size() - i, cp);
+        valid = len != 0;
+      }
+      benchmark::DoNotOptimize(valid);
+    }
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_utf8_validate, false)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_utf8_validate, true)->Arg(0)->Arg(1);
+
+void BM_utf8_is_ascii(benchmark::State& state)
+{
+  const bev::string_view sv{utf8_text(true)};
+  for (auto _ : state)
+    benchmark::DoNotOptimize(bev::utf8::is_ascii(sv));
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(sv.size()));
+}
+
+BENCHMARK(BM_utf8_is_ascii);
+
+// ---- Parsing ----
+
+// 1024 comma-separated numbers, either integers of 1 to 19 digits or
+// decimals with up to 6 fractional digits, parsed either by copying each
+// field into a `std::string` for `strtoull()`/`strtod()`, or with
+// `bev::consume_number()` directly from the view.
+std::string make_numbers(bool decimals)
+{
+  std::string result;
+  uint64_t x = 1;
+  for (size_t i = 0; i < 1024; ++i) {
+    x = x * 6364136223846793005u + 1442695040888963407u;
+    std::string number = std::to_string(x >> (x % 60 + 1));
+    if (decimals)
+      number.insert(number.size() - std::min<size_t>(number.size() - 1, x % 7), ".");
+    result += number;
+    result += ',';
+  }
+  return result;
+}
+
+template<typename T, bool Bev>
+void BM_parse(benchmark::State& state)
+{
+  const std::string storage = make_numbers(std::is_same_v<T, double>);
+  for (auto _ : state) {
+    bev::string_view rest{storage};
+    T total = 0;
+    while (!rest.empty()) {
+      if constexpr (Bev) {
+        total += bev::consume_number<T>(rest).value;
+      } else {
+        const size_t end = rest.find(',');
+        const std::string field(rest.data(), end);
+        if constexpr (std::is_same_v<T, double>)
+          total += std::strtod(field.c_str(), nullptr);
+        else
+          total += std::strtoull(field.c_str(), nullptr, 10);
+        rest.remove_prefix(end);
+      }
+      rest.remove_prefix(1);
+    }
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) *
+                          int64_t(storage.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_parse, uint64_t, false);
+BENCHMARK_TEMPLATE(BM_parse, uint64_t, true);
+BENCHMARK_TEMPLATE(BM_parse, double, false);
+BENCHMARK_TEMPLATE(BM_parse, double, true);
+
+// ---- Interning ----
+
+// 64K identifiers of 8 to 23 bytes, drawn from `range(0)` distinct ones,
+// interned either into a `std::unordered_set<std::string>` or into a
+// `bev::string_interner`.
+const std::vector<std::string>& identifier_stream(size_t distinct)
+{
+  static std::vector<std::string> names;
+  static std::vector<std::string> stream;
+  if (names.size() != distinct) {
+    names.clear();
+    for (size_t i = 0; i < distinct; ++i)
+      names.push_back(make_printable(8 + i % 16, 1000 + uint32_t(i)));
+    stream.clear();
+    uint32_t x = 1;
+    for (size_t i = 0; i < (64 << 10); ++i) {
+      x = x * 1664525u + 1013904223u;
+      stream.push_back(names[x % distinct]);
+    }
+  }
+  return stream;
+}
+
+template<bool Interner>
+void BM_intern(benchmark::State& state)
+{
+  const std::vector<std::string>& stream =
+      identifier_stream(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    if constexpr (Interner) {
+      bev::string_interner set;
+      for (const std::string& name : stream)
+        benchmark::DoNotOptimize(set.intern(name).data());
+    } else {
+      std::unordered_set<std::string> set;
+      for (const std::string& name : stream)
+        benchmark::DoNotOptimize(set.insert(name).first->data());
+    }
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) *
+                          int64_t(stream.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_intern, false)->Range(64, 64 << 10);
+BENCHMARK_TEMPLATE(BM_intern, true)->Range(64, 64 << 10);
+
+// ---- Output ----
+
+// A log line of 16 fields of `range(0)` bytes, written into a
+// `std::ostringstream` either one character at a time, as `operator<<` did
+// before, or with `operator<<` of the views.
+template<bool Bev>
+void BM_ostream(benchmark::State& state)
+{
+  const std::string storage =
+      make_printable(static_cast<size_t>(state.range(0)) * 16, 1);
+  std::vector<bev::string_view> fields;
+  for (size_t i = 0; i < 16; ++i)
+    fields.push_back(bev::string_view{storage}.substr(
+        i * static_cast<size_t>(state.range(0)),
+        static_cast<size_t>(state.range(0))));
+  std::ostringstream os;
+  for (auto _ : state) {
+    os.seekp(0);
+    for (bev::string_view field : fields) {
+      if constexpr (Bev) {
+        os << field;
+      } else {
+        for (char c : field)
+          os << c;
+      }
+    }
+    benchmark::DoNotOptimize(os.tellp());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) *
+                          int64_t(storage.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_ostream, false)->Arg(8)->Arg(64);
+BENCHMARK_TEMPLATE(BM_ostream, true)->Arg(8)->Arg(64);
+
+// ---- Offset views ----
+
+// A sorted index of `range(0)` identifiers in one arena, searched with
+// `std::lower_bound()` for a stream of 4096 of them, with the index holding
+// either 16-byte views or 8-byte offset views.
+template<bool Offsets>
+void BM_index_lookup(benchmark::State& state)
+{
+  const size_t count = static_cast<size_t>(state.range(0));
+  std::string arena;
+  for (size_t i = 0; i < count; ++i)
+    arena += make_printable(8 + i % 16, 1000 + uint32_t(i));
+  std::vector<bev::string_view> views;
+  for (size_t i = 0, pos = 0; i < count; pos += 8 + i % 16, ++i)
+    views.push_back(bev::string_view{arena}.substr(pos, 8 + i % 16));
+  std::vector<bev::string_view> queries;
+  uint32_t x = 1;
+  for (size_t i = 0; i < 4096; ++i) {
+    x = x * 1664525u + 1013904223u;
+    queries.push_back(views[x % count]);
+  }
+  std::sort(views.begin(), views.end());
+
+  const bev::offset_base base{arena};
+  std::vector<bev::offset_view> offsets;
+  for (bev::string_view sv : views)
+    offsets.push_back(base.make(sv));
+
+  for (auto _ : state) {
+    for (bev::string_view query : queries) {
+      if constexpr (Offsets)
+        benchmark::DoNotOptimize(
+            std::lower_bound(offsets.begin(), offsets.end(), query,
+                             base.less()));
+      else
+        benchmark::DoNotOptimize(
+            std::lower_bound(views.begin(), views.end(), query));
+    }
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) *
+                          int64_t(queries.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_index_lookup, false)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_index_lookup, true)->Range(1 << 10, 1 << 20);
+
+// ---- Sorted sets ----
+
+// `range(0)` route names that all start with "/api/v1/", searched for a
+// stream of 4096 of them, and built from unsorted names, either with a
+// sorted `std::vector` and `std::lower_bound()` or with a
+// `bev::sorted_view_set`.
+const std::vector<std::string>& route_names(size_t count)
+{
+  static std::vector<std::string> names;
+  if (names.size() != count) {
+    names.clear();
+    for (size_t i = 0; i < count; ++i)
+      names.push_back("/api/v1/" + make_printable(8 + i % 16, 1000 + uint32_t(i)));
+  }
+  return names;
+}
+
+template<bool Bev>
+void BM_sorted_lookup(benchmark::State& state)
+{
+  const std::vector<std::string>& names =
+      route_names(static_cast<size_t>(state.range(0)));
+  std::vector<bev::string_view> queries;
+  uint32_t x = 1;
+  for (size_t i = 0; i < 4096; ++i) {
+    x = x * 1664525u + 1013904223u;
+    queries.push_back(names[x % names.size()]);
+  }
+  std::vector<bev::string_view> sorted(names.begin(), names.end());
+  std::sort(sorted.begin(), sorted.end());
+  const bev::sorted_view_set set{names.begin(), names.end()};
+
+  for (auto _ : state) {
+    for (bev::string_view query : queries) {
+      if constexpr (Bev)
+        benchmark::DoNotOptimize(set.lower_bound(query));
+      else
+        benchmark::DoNotOptimize(
+            std::lower_bound(sorted.begin(), sorted.end(), query));
+    }
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) *
+                          int64_t(queries.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_sorted_lookup, false)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_sorted_lookup, true)->Range(1 << 10, 1 << 20);
+
+template<bool Bev>
+void BM_sorted_build(benchmark::State& state)
+{
+  const std::vector<std::string>& names =
+      route_names(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    if constexpr (Bev) {
+      const bev::sorted_view_set set{names.begin(), names.end()};
+      benchmark::DoNotOptimize(set.size());
+    } else {
+      std::vector<bev::string_view> sorted(names.begin(), names.end());
+      std::sort(sorted.begin(), sorted.end());
+      benchmark::DoNotOptimize(sorted.data());
+    }
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) *
+                          int64_t(names.size()));
+}
+
+BENCHMARK_TEMPLATE(BM_sorted_build, false)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_sorted_build, true)->Range(1 << 10, 1 << 20);
+
+} // namespace
+
+BENCHMARK_MAIN();
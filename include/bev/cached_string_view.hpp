@@ -0,0 +1,227 @@
+// A view that checks for the null terminator once, when it is created, and
+// stores the result in the second-highest bit of its length:
+//
+//     const bev::cached_string_view path{request.path()};
+//     // Later, in the hot path, without loading `path.data()[path.size()]`:
+//     if (path.is_cstring())
+//       ::stat(path.data(), &st);
+//
+// `basic_string_view::is_cstring()` reads the character after the view on
+// every call, which is often on a cache line that the caller didn't touch
+// otherwise. `basic_cached_string_view::is_cstring()` only tests a bit. The
+// check is repeated when the end of the view moves, by `substr()` or
+// `remove_suffix()`, where the character after the new end is inside the
+// previous view.
+//
+// In exchange, the result doesn't follow changes of the string: if the
+// character after the view is overwritten later, `is_cstring()` keeps
+// returning the cached answer. `max_size()` of `basic_string_view` already
+// leaves both of the highest bits of the length unused.
+
+#pragma once
+
+#include <bev/string_view.hpp>
+
+#include <stdexcept>
+
+namespace bev {
+
+  /**
+   *  @brief  A basic_string_view with a cached result of `is_cstring()`.
+   *
+   *  @tparam CharT   Type of character
+   *  @tparam Traits  Traits for character type
+   *
+   *  Has the same size as `basic_string_view`, and converts implicitly to
+   *  it, with the safederef flag preserved.
+   */
+template<typename CharT, typename Traits = std::char_traits<CharT>>
+class basic_cached_string_view
+{
+  static constexpr size_t safederef_flag_mask =
+      size_t(1) << (CHAR_BIT * sizeof(size_t) - 1);
+  static constexpr size_t cstring_flag_mask = safederef_flag_mask >> 1;
+  static constexpr size_t flag_mask = safederef_flag_mask | cstring_flag_mask;
+
+public:
+  using view_type       = basic_string_view<CharT, Traits>;
+  using traits_type     = Traits;
+  using value_type      = CharT;
+  using const_pointer   = const CharT*;
+  using const_reference = const CharT&;
+  using const_iterator  = typename view_type::const_iterator;
+  using iterator        = const_iterator;
+  using size_type       = size_t;
+  using difference_type = ptrdiff_t;
+  static constexpr size_type npos = size_type(-1);
+
+  constexpr
+  basic_cached_string_view() noexcept = default;
+
+  // Checks `sv.is_cstring()` once.
+  explicit
+  basic_cached_string_view(view_type sv) noexcept
+    : basic_cached_string_view{sv.data(), sv.size(), sv.is_cstring(),
+                               view_type::test_safederef_bit(sv.len_)}
+  { }
+
+  // Null-terminated by construction, so the terminator is not read.
+  constexpr
+  basic_cached_string_view(const CharT* str) noexcept
+    : basic_cached_string_view{str, traits_type::length(str), true, true}
+  { }
+
+  basic_cached_string_view(const std::basic_string<CharT, Traits>& s) noexcept
+    : basic_cached_string_view{s.data(), s.size(), true, true}
+  { }
+
+  basic_cached_string_view(std::basic_string<CharT, Traits>&&) = delete;
+
+  constexpr
+  operator view_type() const noexcept
+  { return this->view(); }
+
+  constexpr view_type
+  view() const noexcept
+  {
+    if (len_ & safederef_flag_mask)
+      return view_type{str_, this->size(), safederef};
+    return view_type{str_, this->size()};
+  }
+
+  // Whether `data()` was null-terminated when the end of the view was last
+  // set, without reading the terminator again.
+  constexpr bool
+  is_cstring() const noexcept
+  { return len_ & cstring_flag_mask; }
+
+  constexpr const CharT*
+  data() const noexcept
+  { return str_; }
+
+  constexpr size_type
+  size() const noexcept
+  { return len_ & ~flag_mask; }
+
+  constexpr size_type
+  length() const noexcept
+  { return this->size(); }
+
+  [[nodiscard]] constexpr bool
+  empty() const noexcept
+  { return this->size() == 0; }
+
+  constexpr const_iterator
+  begin() const noexcept
+  { return str_; }
+
+  constexpr const_iterator
+  end() const noexcept
+  { return str_ + this->size(); }
+
+  constexpr const_reference
+  operator[](size_type pos) const noexcept
+  { return str_[pos]; }
+
+  constexpr const_reference
+  front() const noexcept
+  { return *str_; }
+
+  constexpr const_reference
+  back() const noexcept
+  { return str_[this->size() - 1]; }
+
+  // The end of the view doesn't move, so the flags stay valid.
+  constexpr void
+  remove_prefix(size_type n) noexcept
+  {
+    str_ += n;
+    len_ -= n;
+  }
+
+  void
+  remove_suffix(size_type n) noexcept
+  {
+    if (n != 0)
+      this->set_end(this->size() - n);
+  }
+
+  // Throws `std::out_of_range` if `pos > size()`, like `std::string_view`.
+  basic_cached_string_view
+  substr(size_type pos = 0, size_type n = npos) const
+  {
+    if (pos > this->size())
+      throw std::out_of_range("cached_string_view::substr");
+    basic_cached_string_view result = *this;
+    result.remove_prefix(pos);
+    if (n < result.size())
+      result.set_end(n);
+    return result;
+  }
+
+  friend constexpr bool
+  operator==(basic_cached_string_view x, basic_cached_string_view y) noexcept
+  { return x.view() == y.view(); }
+
+  friend constexpr bool
+  operator!=(basic_cached_string_view x, basic_cached_string_view y) noexcept
+  { return x.view() != y.view(); }
+
+  friend constexpr bool
+  operator< (basic_cached_string_view x, basic_cached_string_view y) noexcept
+  { return x.view() < y.view(); }
+
+  friend constexpr bool
+  operator> (basic_cached_string_view x, basic_cached_string_view y) noexcept
+  { return x.view() > y.view(); }
+
+  friend constexpr bool
+  operator<=(basic_cached_string_view x, basic_cached_string_view y) noexcept
+  { return x.view() <= y.view(); }
+
+  friend constexpr bool
+  operator>=(basic_cached_string_view x, basic_cached_string_view y) noexcept
+  { return x.view() >= y.view(); }
+
+private:
+  constexpr
+  basic_cached_string_view(const CharT* str, size_type len, bool cstring,
+                           bool deref) noexcept
+    : str_{str}
+    , len_{len | (cstring ? cstring_flag_mask : 0)
+               | (deref ? safederef_flag_mask : 0)}
+  { }
+
+  // Moves the end of the view to `len`, which is less than `size()`, and
+  // checks the new terminator, which lies within the previous view and so
+  // can always be dereferenced.
+  void
+  set_end(size_type len) noexcept
+  {
+    len_ = len | safederef_flag_mask
+         | (traits_type::eq(str_[len], CharT{0}) ? cstring_flag_mask : 0);
+  }
+
+  const CharT* str_ = nullptr;
+  size_type len_ = 0;
+};
+
+// basic_cached_string_view typedef names
+using cached_string_view = basic_cached_string_view<char>;
+using wcached_string_view = basic_cached_string_view<wchar_t>;
+using u16cached_string_view = basic_cached_string_view<char16_t>;
+using u32cached_string_view = basic_cached_string_view<char32_t>;
+
+} // namespace bev
+
+namespace std {
+
+template<typename CharT>
+struct hash<bev::basic_cached_string_view<CharT>>
+{
+  constexpr size_t
+  operator()(const bev::basic_cached_string_view<CharT>& str) const noexcept
+  { return bev::hash<>{}(str.view()); }
+};
+
+} // namespace std
@@ -0,0 +1,138 @@
+// Case-insensitive views for ASCII text, such as HTTP header names, without
+// lowercasing them into a temporary string first:
+//
+//     std::unordered_map<bev::ci_string_view, header_handler> handlers{
+//       {"Content-Length"_sv, &on_content_length},
+//       {"Transfer-Encoding"_sv, &on_transfer_encoding},
+//     };
+//     // Finds the handler for "content-length" and "CONTENT-LENGTH" alike.
+//     auto it = handlers.find(name);
+//
+// `bev::ci_string_view` is a `bev::basic_string_view` with the traits
+// `bev::ascii_ci_traits`, which consider 'A' to 'Z' equal to their lowercase
+// versions and leave all other bytes, including UTF-8 sequences, alone. So
+// `compare()`, `operator==`, `find()`, `starts_with()` and the `find_*_of()`
+// family are all case-insensitive, and `std::hash` hashes the folded bytes.
+// Comparing and searching fold whole vectors of bytes at once with the
+// kernels from `bev/detail/simd.hpp`.
+//
+// `bev::ci_string_view` and `bev::string_view` convert implicitly into each
+// other without any cost. Comparisons of one with the other are ambiguous,
+// so convert one side to choose whether case matters.
+
+#pragma once
+
+#include <bev/string_view.hpp>
+
+#include <algorithm>
+
+namespace bev {
+
+  /**
+   *  @brief  Character traits for `char` that ignore the case of ASCII
+   *          letters.
+   *
+   *  Orders strings like `std::char_traits<char>` does their lowercase
+   *  versions.
+   */
+struct ascii_ci_traits : std::char_traits<char>
+{
+  static constexpr char
+  fold(char c) noexcept
+  { return detail::fold_ascii_case(c); }
+
+  static constexpr bool
+  eq(char a, char b) noexcept
+  { return fold(a) == fold(b); }
+
+  static constexpr bool
+  lt(char a, char b) noexcept
+  {
+    return static_cast<unsigned char>(fold(a))
+         < static_cast<unsigned char>(fold(b));
+  }
+
+  static constexpr int
+  compare(const char* a, const char* b, size_t n) noexcept
+  {
+#if defined(BEV_STRING_VIEW_HAS_KERNELS)
+    if (!BEV_STRING_VIEW_IS_CONSTANT_EVALUATED())
+      return detail::ci_compare_kernel(a, b, n);
+#endif
+    return detail::scalar::ci_compare(a, b, n);
+  }
+
+  static constexpr const char*
+  find(const char* p, size_t n, const char& c) noexcept
+  {
+#if defined(BEV_STRING_VIEW_HAS_KERNELS)
+    if (!BEV_STRING_VIEW_IS_CONSTANT_EVALUATED()) {
+      const size_t ret = detail::ci_find_kernel(p, n, c);
+      return ret == detail::kernel_npos ? nullptr : p + ret;
+    }
+#endif
+    for (size_t i = 0; i < n; ++i)
+      if (eq(p[i], c))
+        return p + i;
+    return nullptr;
+  }
+
+  // Hashes the folded bytes, in chunks for long strings. Strings of up to
+  // one chunk hash like their lowercase versions with `std::char_traits`.
+  template<typename Algorithm>
+  static constexpr uint64_t
+  hash_bytes(const char* p, size_t n) noexcept
+  {
+#if defined(BEV_STRING_VIEW_IS_CONSTANT_EVALUATED)
+    if (!BEV_STRING_VIEW_IS_CONSTANT_EVALUATED())
+      return hash_folded<Algorithm>(p, n);
+#endif
+    char buffer[hash_chunk] = {};
+    return hash_folded<Algorithm>(p, n, buffer);
+  }
+
+private:
+  static constexpr size_t hash_chunk = 256;
+
+  // Without constant evaluation, the buffer doesn't need to be initialized.
+  template<typename Algorithm>
+  static uint64_t
+  hash_folded(const char* p, size_t n) noexcept
+  {
+    char buffer[hash_chunk];
+    return hash_folded<Algorithm>(p, n, buffer);
+  }
+
+  template<typename Algorithm>
+  static constexpr uint64_t
+  hash_folded(const char* p, size_t n, char* buffer) noexcept
+  {
+    uint64_t result = 0;
+    size_t i = 0;
+    do {
+      const size_t m = std::min(hash_chunk, n - i);
+      for (size_t j = 0; j < m; ++j)
+        buffer[j] = fold(p[i + j]);
+      result = i == 0 ? Algorithm::hash_bytes(buffer, m)
+                      : Algorithm::hash_bytes(buffer, m, result);
+      i += m;
+    } while (i < n);
+    return result;
+  }
+};
+
+using ci_string_view = basic_string_view<char, ascii_ci_traits>;
+
+} // namespace bev
+
+namespace std {
+
+template<>
+struct hash<bev::ci_string_view>
+{
+  constexpr size_t
+  operator()(const bev::ci_string_view& str) const noexcept
+  { return bev::hash<>{}(str); }
+};
+
+} // namespace std
@@ -0,0 +1,148 @@
+// Null-terminated versions of many views at once, e.g. for a loop of
+// syscalls or the argument vector of `execve()`:
+//
+//     bev::cstring_batch paths;
+//     for (const request& r : requests) {
+//       paths.assign(r.paths);
+//       for (size_t i = 0; i < paths.size(); ++i)
+//         ::stat(paths[i], &st[i]);
+//     }
+//
+//     bev::cstring_batch argv{"/bin/ls"_sv, "-l"_sv, dir};
+//     ::execv(argv[0], const_cast<char* const*>(argv.c_strs()));
+//
+// Views for which `is_cstring()` is true are passed through, and the others
+// are copied with a null character into a single buffer, which is sized once
+// per `assign()` and reused by later calls. So in the steady state resolving
+// a batch doesn't allocate at all, instead of once per copied view.
+
+#pragma once
+
+#include <bev/string_view.hpp>
+
+#include <initializer_list>
+#include <iterator>
+#include <vector>
+
+namespace bev {
+
+  /**
+   *  @brief  A reusable array of null-terminated strings.
+   *
+   *  @tparam CharT   Type of character
+   *  @tparam Traits  Traits for character type
+   *
+   *  The pointers are valid until the next call of `assign()` or
+   *  `clear()`, and as long as the original views are.
+   */
+template<typename CharT, typename Traits = std::char_traits<CharT>>
+class basic_cstring_batch
+{
+public:
+  using view_type = basic_string_view<CharT, Traits>;
+  using size_type = size_t;
+
+  basic_cstring_batch()
+    : pointers_(1, nullptr)
+  { }
+
+  template<typename Range>
+  explicit
+  basic_cstring_batch(const Range& views)
+    : basic_cstring_batch{}
+  { this->assign(views); }
+
+  explicit
+  basic_cstring_batch(std::initializer_list<view_type> views)
+    : basic_cstring_batch{}
+  { this->assign(views); }
+
+  // The buffer holds pointers into itself.
+  basic_cstring_batch(const basic_cstring_batch&) = delete;
+  basic_cstring_batch& operator=(const basic_cstring_batch&) = delete;
+
+  // Replaces the strings with null-terminated versions of the elements of
+  // `views`, which have to be convertible to `view_type`, and returns
+  // `c_strs()`. The range is traversed twice.
+  template<typename Range>
+  const CharT* const*
+  assign(const Range& views)
+  {
+    // Collect the pass-through pointers and the size of the copies first,
+    // so that the buffer is resized at most once.
+    pointers_.clear();
+    size_type total = 0;
+    for (const auto& element : views) {
+      const view_type sv = element;
+      if (sv.is_cstring()) {
+        pointers_.push_back(sv.data());
+      } else {
+        pointers_.push_back(nullptr);
+        total += sv.size() + 1;
+      }
+    }
+    buffer_.resize(total);
+    CharT* dst = buffer_.data();
+    copied_ = 0;
+    size_type i = 0;
+    for (const auto& element : views) {
+      if (!pointers_[i]) {
+        const view_type sv = element;
+        Traits::copy(dst, sv.data(), sv.size());
+        Traits::assign(dst[sv.size()], CharT{0});
+        pointers_[i] = dst;
+        dst += sv.size() + 1;
+        ++copied_;
+      }
+      ++i;
+    }
+    pointers_.push_back(nullptr);
+    return this->c_strs();
+  }
+
+  const CharT* const*
+  assign(std::initializer_list<view_type> views)
+  { return this->assign<std::initializer_list<view_type>>(views); }
+
+  // The strings, followed by a null pointer as required for `argv` and
+  // `envp`.
+  const CharT* const*
+  c_strs() const noexcept
+  { return pointers_.data(); }
+
+  const CharT*
+  operator[](size_type i) const noexcept
+  { return pointers_[i]; }
+
+  size_type
+  size() const noexcept
+  { return pointers_.size() - 1; }
+
+  [[nodiscard]] bool
+  empty() const noexcept
+  { return this->size() == 0; }
+
+  // The number of strings that had to be copied.
+  size_type
+  copied() const noexcept
+  { return copied_; }
+
+  // Removes the strings, but keeps the memory for reuse.
+  void
+  clear() noexcept
+  {
+    pointers_.resize(1);
+    pointers_[0] = nullptr;
+    copied_ = 0;
+  }
+
+private:
+  std::vector<const CharT*> pointers_;
+  std::vector<CharT> buffer_;
+  size_type copied_ = 0;
+};
+
+using cstring_batch = basic_cstring_batch<char>;
+using wcstring_batch = basic_cstring_batch<wchar_t>;
+
+} // namespace bev
@@ -0,0 +1,1905 @@
+// Vectorized search kernels used by `bev::basic_string_view` for `char`
+// views using the default `std::char_traits<char>`.
+//
+// All kernels operate on plain `(const char*, size_t)` ranges and are selected
+// at compile time based on the instruction sets enabled for the translation
+// unit: AVX2 if `__AVX2__` is defined, otherwise SSE2 (or SSSE3 for the
+// kernels that need byte shuffles) on x86-64 and NEON on AArch64. Defining
+// `BEV_STRING_VIEW_NO_SIMD` disables all of them, and `basic_string_view`
+// falls back to the generic loops from libstdc++.
+//
+// The kernels live in a namespace named after the selected instruction set,
+// so that translation units compiled with different flags don't share (and
+// the linker doesn't merge) inline functions containing different code.
+//
+// If `BEV_STRING_VIEW_RUNTIME_DISPATCH` is defined, which the compiled
+// `bev::string_view_simd` target does for its users, the entry points at the
+// end of this file call through a table of kernels that is selected once at
+// runtime based on the CPU, see `bev/simd.hpp`.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#if !defined(BEV_STRING_VIEW_NO_SIMD)
+#  if defined(__AVX2__)
+#    define BEV_STRING_VIEW_AVX2 1
+#  endif
+#  if defined(__SSSE3__) || defined(__AVX2__)
+#    define BEV_STRING_VIEW_SSSE3 1
+#  endif
+#  if defined(__SSE2__) || defined(_M_X64) \
+      || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define BEV_STRING_VIEW_SSE2 1
+#  endif
+#  if defined(__ARM_NEON) && defined(__aarch64__)
+#    define BEV_STRING_VIEW_NEON 1
+#  endif
+#endif
+
+#if defined(BEV_STRING_VIEW_AVX2)
+#  include <immintrin.h>
+#elif defined(BEV_STRING_VIEW_SSSE3)
+#  include <tmmintrin.h>
+#elif defined(BEV_STRING_VIEW_SSE2)
+#  include <emmintrin.h>
+#elif defined(BEV_STRING_VIEW_NEON)
+#  include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#  include <intrin.h>
+#endif
+
+// glibc provides a vectorized `memrchr()` as a GNU extension.
+#if defined(__GLIBC__) && defined(__USE_GNU)
+#  define BEV_STRING_VIEW_HAS_MEMRCHR 1
+#endif
+
+// The kernels can not be used during constant evaluation, so the `constexpr`
+// member functions of `basic_string_view` need to detect it. Without compiler
+// support for that, the kernels are disabled entirely.
+#if defined(__cpp_lib_is_constant_evaluated)
+#  define BEV_STRING_VIEW_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif (defined(__GNUC__) && __GNUC__ >= 9) || defined(__clang__) \
+      || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#  define BEV_STRING_VIEW_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+
+#if defined(BEV_STRING_VIEW_IS_CONSTANT_EVALUATED) \
+    && !defined(BEV_STRING_VIEW_NO_SIMD)
+#  define BEV_STRING_VIEW_HAS_KERNELS 1
+#endif
+
+#if defined(BEV_STRING_VIEW_AVX2)
+#  define BEV_STRING_VIEW_ISA_NAMESPACE isa_avx2
+#  define BEV_STRING_VIEW_ISA_LEVEL avx2
+#elif defined(BEV_STRING_VIEW_SSSE3)
+#  define BEV_STRING_VIEW_ISA_NAMESPACE isa_ssse3
+#  define BEV_STRING_VIEW_ISA_LEVEL ssse3
+#elif defined(BEV_STRING_VIEW_SSE2)
+#  define BEV_STRING_VIEW_ISA_NAMESPACE isa_sse2
+#  define BEV_STRING_VIEW_ISA_LEVEL sse2
+#elif defined(BEV_STRING_VIEW_NEON)
+#  define BEV_STRING_VIEW_ISA_NAMESPACE isa_neon
+#  define BEV_STRING_VIEW_ISA_LEVEL neon
+#else
+#  define BEV_STRING_VIEW_ISA_NAMESPACE isa_scalar
+#  define BEV_STRING_VIEW_ISA_LEVEL scalar
+#endif
+
+#if defined(BEV_STRING_VIEW_RUNTIME_DISPATCH)
+#  include <atomic>
+#endif
+
+namespace bev {
+namespace detail {
+
+// Whether a view with the given character type and traits compares plain
+// bytes, so that it can be handled by the byte-oriented code in this file.
+template<typename CharT, typename Traits>
+inline constexpr bool is_default_char_v =
+    std::is_same_v<CharT, char>
+    && std::is_same_v<Traits, std::char_traits<char>>;
+
+// Whether the kernels in this file can be used for a view with the given
+// character type and traits.
+template<typename CharT, typename Traits>
+inline constexpr bool has_kernels_v =
+#if defined(BEV_STRING_VIEW_HAS_KERNELS)
+    is_default_char_v<CharT, Traits>;
+#else
+    false;
+#endif
+
+inline constexpr size_t kernel_npos = size_t(-1);
+
+// Whether `class_bitmask_kernel()` can use byte shuffles. Without them,
+// classifying one character at a time is not slower than building a bitmask.
+inline constexpr bool has_vectorized_class_bitmask =
+#if defined(BEV_STRING_VIEW_SSSE3) || defined(BEV_STRING_VIEW_NEON) \
+    || defined(BEV_STRING_VIEW_RUNTIME_DISPATCH)
+    true;
+#else
+    false;
+#endif
+
+// A set of bytes, stored both as a 256-bit bitmap and as a pair of nibble
+// lookup tables for the vectorized classification kernels.
+//
+// The nibble tables map the low and the high nibble of a byte to a bitmask of
+// up to 8 buckets each, and a byte is in the set if both masks share a bucket.
+// High nibbles that appear with the same set of low nibbles are assigned to
+// the same bucket, which makes the classification exact as long as there are
+// at most 8 distinct such sets. Otherwise `vectorizable` is false and only
+// the bitmap can be used.
+struct byte_class
+{
+  uint64_t bits[4] = {};
+  uint8_t lo[16] = {};
+  uint8_t hi[16] = {};
+  bool vectorizable = true;
+
+  constexpr bool
+  contains(char c) const noexcept
+  {
+    const unsigned char u = static_cast<unsigned char>(c);
+    return (bits[u >> 6] >> (u & 63)) & 1;
+  }
+};
+
+constexpr byte_class
+make_byte_class(const char* s, size_t n) noexcept
+{
+  byte_class result;
+  uint16_t low_nibbles[16] = {};
+  for (size_t i = 0; i < n; ++i) {
+    const unsigned char c = static_cast<unsigned char>(s[i]);
+    result.bits[c >> 6] |= uint64_t(1) << (c & 63);
+    low_nibbles[c >> 4] |= static_cast<uint16_t>(1u << (c & 15));
+  }
+
+  uint16_t buckets[8] = {};
+  int nbuckets = 0;
+  for (int h = 0; h < 16; ++h) {
+    if (!low_nibbles[h])
+      continue;
+    int b = 0;
+    while (b < nbuckets && buckets[b] != low_nibbles[h])
+      ++b;
+    if (b == nbuckets) {
+      if (nbuckets == 8) {
+        result.vectorizable = false;
+        return result;
+      }
+      buckets[nbuckets++] = low_nibbles[h];
+    }
+    result.hi[h] |= static_cast<uint8_t>(1u << b);
+  }
+  for (int b = 0; b < nbuckets; ++b)
+    for (int l = 0; l < 16; ++l)
+      if ((buckets[b] >> l) & 1)
+        result.lo[l] |= static_cast<uint8_t>(1u << b);
+  return result;
+}
+
+// The tables of a Teddy prefilter for up to 8 buckets of patterns, see
+// `bev/multi_searcher.hpp`. A position is a candidate for a bucket if the
+// bucket has a pattern with the same `j`-th byte, for each of the first
+// `width` bytes of the position.
+//
+// The vectorized kernels only look up the nibbles of each byte, in `lo[j]`
+// and `hi[j]`, which allows some false candidates. The scalar code uses the
+// exact tables in `bytes[j]`.
+struct teddy_masks
+{
+  uint8_t lo[3][16] = {};
+  uint8_t hi[3][16] = {};
+  uint8_t bytes[3][256] = {};
+  size_t width = 1;
+
+  // Adds `c` as the `j`-th byte of a pattern in `bucket`.
+  constexpr void
+  add(size_t j, char c, int bucket) noexcept
+  {
+    const unsigned char u = static_cast<unsigned char>(c);
+    lo[j][u & 15] |= static_cast<uint8_t>(1u << bucket);
+    hi[j][u >> 4] |= static_cast<uint8_t>(1u << bucket);
+    bytes[j][u] |= static_cast<uint8_t>(1u << bucket);
+  }
+
+  // Returns the buckets that are candidates for a match starting at `p`.
+  constexpr uint8_t
+  buckets(const char* p) const noexcept
+  {
+    uint8_t result = bytes[0][static_cast<unsigned char>(p[0])];
+    for (size_t j = 1; j < width; ++j)
+      result &= bytes[j][static_cast<unsigned char>(p[j])];
+    return result;
+  }
+};
+
+// The instruction sets for which kernels exist, in the order of preference.
+enum class isa_level
+{
+  scalar,
+  sse2,
+  ssse3,
+  avx2,
+  neon,
+};
+
+// The kernels for one instruction set, in the form used by the runtime
+// dispatch. All of them have the same semantics as the entry points at the
+// end of this file.
+struct kernel_table
+{
+  isa_level level;
+  size_t (*find)(const char*, size_t, const char*, size_t) noexcept;
+  size_t (*rfind)(const char*, size_t, const char*, size_t) noexcept;
+  size_t (*rfind_char)(const char*, size_t, char) noexcept;
+  size_t (*find_first_of)(const char*, size_t, const byte_class&) noexcept;
+  size_t (*find_first_not_of)(const char*, size_t, const byte_class&) noexcept;
+  size_t (*find_last_of)(const char*, size_t, const byte_class&) noexcept;
+  size_t (*find_last_not_of)(const char*, size_t, const byte_class&) noexcept;
+  bool (*equal)(const char*, const char*, size_t) noexcept;
+  size_t (*teddy)(const char*, size_t, const teddy_masks&) noexcept;
+  uint64_t (*class_bitmask)(const char*, size_t, const byte_class&) noexcept;
+  int (*ci_compare)(const char*, const char*, size_t) noexcept;
+  size_t (*ci_find)(const char*, size_t, char) noexcept;
+  bool (*is_ascii)(const char*, size_t) noexcept;
+  bool (*utf8_validate)(const char*, size_t) noexcept;
+};
+
+// Maps 'A' to 'Z' to lowercase and leaves all other bytes unchanged, which is
+// the case folding of `bev::ascii_ci_traits`.
+constexpr char
+fold_ascii_case(char c) noexcept
+{
+  return static_cast<unsigned char>(c - 'A') < 26 ? static_cast<char>(c | 0x20)
+                                                  : c;
+}
+
+// Decodes the UTF-8 sequence at the start of the `n > 0` bytes at `p` into
+// `cp`, and returns its length, or 0 if it is not valid UTF-8: truncated,
+// overlong, a surrogate or above U+10FFFF.
+constexpr size_t
+decode_utf8(const char* p, size_t n, char32_t& cp) noexcept
+{
+  const auto byte = [p](size_t i) { return static_cast<unsigned char>(p[i]); };
+  const unsigned char b0 = byte(0);
+  if (b0 < 0x80) {
+    cp = b0;
+    return 1;
+  }
+  // The range of the second byte depends on the first one, the others are
+  // always continuation bytes.
+  size_t len = 0;
+  unsigned char lo = 0x80, hi = 0xbf;
+  if (b0 < 0xc2) {
+    return 0;
+  } else if (b0 < 0xe0) {
+    len = 2;
+    cp = b0 & 0x1f;
+  } else if (b0 < 0xf0) {
+    len = 3;
+    cp = b0 & 0x0f;
+    if (b0 == 0xe0)
+      lo = 0xa0;
+    else if (b0 == 0xed)
+      hi = 0x9f;
+  } else if (b0 < 0xf5) {
+    len = 4;
+    cp = b0 & 0x07;
+    if (b0 == 0xf0)
+      lo = 0x90;
+    else if (b0 == 0xf4)
+      hi = 0x8f;
+  } else {
+    return 0;
+  }
+  if (n < len || byte(1) < lo || byte(1) > hi)
+    return 0;
+  cp = (cp << 6) | (byte(1) & 0x3f);
+  for (size_t i = 2; i < len; ++i) {
+    if ((byte(i) & 0xc0) != 0x80)
+      return 0;
+    cp = (cp << 6) | (byte(i) & 0x3f);
+  }
+  return len;
+}
+
+// The tables of the UTF-8 validation by Keiser and Lemire, "Validating UTF-8
+// In Less Than One Instruction Per Byte" (2021). Every pair of adjacent
+// bytes is looked up by the high and the low nibble of the first and the
+// high nibble of the second byte, and each table has a bit set for every
+// kind of error that the nibble is consistent with. So the pair is invalid
+// if all three lookups share a bit.
+namespace utf8_error {
+inline constexpr uint8_t too_short = 1 << 0;   // 11______ 0_______
+                                               // 11______ 11______
+inline constexpr uint8_t too_long = 1 << 1;    // 0_______ 10______
+inline constexpr uint8_t overlong_3 = 1 << 2;  // 11100000 100_____
+inline constexpr uint8_t too_large = 1 << 3;   // 11110100 1001____ etc.
+inline constexpr uint8_t surrogate = 1 << 4;   // 11101101 101_____
+inline constexpr uint8_t overlong_2 = 1 << 5;  // 1100000_ 10______
+inline constexpr uint8_t too_large_1000 = 1 << 6; // 11110101 1000____ etc.
+inline constexpr uint8_t overlong_4 = 1 << 6;  // 11110000 1000____
+inline constexpr uint8_t two_conts = 1 << 7;   // 10______ 10______
+// The errors that only depend on the high nibble of the first byte.
+inline constexpr uint8_t carry = too_short | too_long | two_conts;
+} // namespace utf8_error
+
+struct utf8_tables
+{
+  uint8_t byte_1_high[16];
+  uint8_t byte_1_low[16];
+  uint8_t byte_2_high[16];
+  // Subtracted with saturation from the last block, to find sequences that
+  // continue past it.
+  uint8_t incomplete[16];
+};
+
+inline constexpr utf8_tables utf8_lookup = [] {
+  using namespace utf8_error;
+  utf8_tables t{};
+  for (int i = 0; i < 16; ++i) {
+    t.byte_1_high[i] = i < 8 ? too_long : i < 12 ? two_conts : too_short;
+    t.byte_1_low[i] = carry | (i >= 4 ? too_large : 0)
+                    | (i >= 5 ? too_large_1000 : 0);
+    t.byte_2_high[i] = i < 8 || i >= 12 ? too_short
+                     : too_long | overlong_2 | two_conts;
+    t.incomplete[i] = 0xff;
+  }
+  t.byte_1_high[12] |= overlong_2;
+  t.byte_1_high[14] |= overlong_3 | surrogate;
+  t.byte_1_high[15] |= too_large | too_large_1000 | overlong_4;
+  t.byte_1_low[0] |= overlong_3 | overlong_2 | overlong_4;
+  t.byte_1_low[1] |= overlong_2;
+  t.byte_1_low[13] |= surrogate;
+  t.byte_2_high[8] |= overlong_3 | too_large_1000 | overlong_4;
+  t.byte_2_high[9] |= overlong_3 | too_large;
+  t.byte_2_high[10] |= surrogate | too_large;
+  t.byte_2_high[11] |= surrogate | too_large;
+  t.incomplete[13] = 0xf0 - 1;
+  t.incomplete[14] = 0xe0 - 1;
+  t.incomplete[15] = 0xc0 - 1;
+  return t;
+}();
+
+namespace BEV_STRING_VIEW_ISA_NAMESPACE {
+
+// Index of the lowest set bit, `x` must not be zero.
+inline int countr_zero(uint32_t x) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;
+  _BitScanForward(&index, x);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctz(x);
+#endif
+}
+
+inline int countr_zero(uint64_t x) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;
+  _BitScanForward64(&index, x);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctzll(x);
+#endif
+}
+
+// Index of the highest set bit, `x` must not be zero.
+inline int bit_index_high(uint32_t x) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;
+  _BitScanReverse(&index, x);
+  return static_cast<int>(index);
+#else
+  return 31 - __builtin_clz(x);
+#endif
+}
+
+inline int bit_index_high(uint64_t x) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;
+  _BitScanReverse64(&index, x);
+  return static_cast<int>(index);
+#else
+  return 63 - __builtin_clzll(x);
+#endif
+}
+
+namespace scalar {
+
+// Returns the offset of the first occurrence of the needle `s` of length `m`
+// in `hay` that starts at or after `pos`, or `kernel_npos`.
+// Requires `1 <= m <= n`.
+inline size_t
+find(const char* hay, size_t n, const char* s, size_t m, size_t pos = 0) noexcept
+{
+  const char* const last = hay + (n - m);
+  for (const char* p = hay + pos; p <= last; ++p) {
+    p = static_cast<const char*>(std::memchr(p, s[0], last - p + 1));
+    if (!p)
+      break;
+    if (std::memcmp(p + 1, s + 1, m - 1) == 0)
+      return p - hay;
+  }
+  return kernel_npos;
+}
+
+// Returns the offset of the last occurrence of the needle `s` of length `m`
+// in `hay` that starts before `end`, or `kernel_npos`.
+// Requires `1 <= m <= n` and `end <= n - m + 1`.
+inline size_t
+rfind(const char* hay, size_t n, const char* s, size_t m, size_t end) noexcept
+{
+  (void)n;
+  while (end-- > 0)
+    if (hay[end] == s[0] && std::memcmp(hay + end + 1, s + 1, m - 1) == 0)
+      return end;
+  return kernel_npos;
+}
+
+// Returns the offset of the last occurrence of `c` in the first `n` bytes
+// of `p`, or `kernel_npos`.
+inline size_t
+rfind(const char* p, size_t n, char c) noexcept
+{
+  while (n-- > 0)
+    if (p[n] == c)
+      return n;
+  return kernel_npos;
+}
+
+// Returns the offset of the first byte at or after `pos` that is in the
+// class `c` (or not in it, if `Negate` is true), or `kernel_npos`.
+template<bool Negate>
+constexpr size_t
+find_first_of(const char* p, size_t n, const byte_class& c,
+              size_t pos = 0) noexcept
+{
+  for (; pos < n; ++pos)
+    if (c.contains(p[pos]) != Negate)
+      return pos;
+  return kernel_npos;
+}
+
+// Returns the offset of the last byte that is in the class `c` (or not in
+// it, if `Negate` is true), or `kernel_npos`.
+template<bool Negate>
+constexpr size_t
+find_last_of(const char* p, size_t n, const byte_class& c) noexcept
+{
+  while (n-- > 0)
+    if (c.contains(p[n]) != Negate)
+      return n;
+  return kernel_npos;
+}
+
+// Returns a bitmask with bit `i` set if `p[i]` is in the class `c`, for the
+// first `min(n, 64)` bytes of `p`.
+constexpr uint64_t
+class_bitmask(const char* p, size_t n, const byte_class& c) noexcept
+{
+  uint64_t mask = 0;
+  for (size_t i = 0; i < n && i < 64; ++i)
+    mask |= uint64_t(c.contains(p[i])) << i;
+  return mask;
+}
+
+// Returns the first candidate position of `t` at or after `pos`, or
+// `kernel_npos`. Only positions that leave room for `t.width` bytes count.
+constexpr size_t
+teddy(const char* p, size_t n, const teddy_masks& t, size_t pos = 0) noexcept
+{
+  for (; pos + t.width <= n; ++pos)
+    if (t.buckets(p + pos))
+      return pos;
+  return kernel_npos;
+}
+
+// Compares the case-folded bytes of `a` and `b` from `pos` on, like
+// `memcmp()`.
+constexpr int
+ci_compare(const char* a, const char* b, size_t n, size_t pos = 0) noexcept
+{
+  for (; pos < n; ++pos) {
+    const unsigned char x = static_cast<unsigned char>(fold_ascii_case(a[pos]));
+    const unsigned char y = static_cast<unsigned char>(fold_ascii_case(b[pos]));
+    if (x != y)
+      return x < y ? -1 : 1;
+  }
+  return 0;
+}
+
+// Returns the offset of the first byte at or after `pos` that is either case
+// of the lowercase letter `c`, or `kernel_npos`. Setting bit 0x20 turns
+// exactly these two bytes into `c`.
+constexpr size_t
+ci_find(const char* p, size_t n, char c, size_t pos = 0) noexcept
+{
+  for (; pos < n; ++pos)
+    if ((p[pos] | 0x20) == c)
+      return pos;
+  return kernel_npos;
+}
+
+// Unaligned loads, only ever compared for equality so the byte order of
+// the result does not matter.
+inline uint32_t
+load_u32(const char* p) noexcept
+{
+  uint32_t result;
+  std::memcpy(&result, p, sizeof(result));
+  return result;
+}
+
+inline uint64_t
+load_u64(const char* p) noexcept
+{
+  uint64_t result;
+  std::memcpy(&result, p, sizeof(result));
+  return result;
+}
+
+inline constexpr uint64_t high_bits = 0x8080808080808080ull;
+
+// Whether all bytes from `pos` on are below 0x80, 8 at a time.
+inline bool
+is_ascii(const char* p, size_t n, size_t pos = 0) noexcept
+{
+  uint64_t bits = 0;
+  for (; pos + 8 <= n; pos += 8)
+    bits |= load_u64(p + pos);
+  for (; pos < n; ++pos)
+    bits |= static_cast<unsigned char>(p[pos]);
+  return (bits & high_bits) == 0;
+}
+
+// Decodes one sequence at a time, skipping runs of ASCII 8 bytes at a time.
+inline bool
+utf8_validate(const char* p, size_t n) noexcept
+{
+  size_t i = 0;
+  while (i < n) {
+    if (i + 8 <= n && (load_u64(p + i) & high_bits) == 0) {
+      i += 8;
+      continue;
+    }
+    char32_t cp;
+    const size_t len = decode_utf8(p + i, n - i, cp);
+    if (len == 0)
+      return false;
+    i += len;
+  }
+  return true;
+}
+
+// Whether the first `n` bytes of `a` and `b` are equal. Ranges of 4 to 16
+// bytes are compared with two overlapping loads for the head and the tail.
+inline bool
+equal(const char* a, const char* b, size_t n) noexcept
+{
+  if (n >= 8) {
+    for (size_t i = 0; i + 8 < n; i += 8)
+      if (load_u64(a + i) != load_u64(b + i))
+        return false;
+    return load_u64(a + n - 8) == load_u64(b + n - 8);
+  }
+  if (n >= 4)
+    return ((load_u32(a) ^ load_u32(b))
+            | (load_u32(a + n - 4) ^ load_u32(b + n - 4))) == 0;
+  if (n == 0)
+    return true;
+  return a[0] == b[0] && a[n / 2] == b[n / 2] && a[n - 1] == b[n - 1];
+}
+
+} // namespace scalar
+
+// The vectorized substring search compares the first and the last character
+// of the needle against a whole block of candidate positions at once, and
+// only calls `memcmp()` for the positions where both of them match. See
+// http://0x80.pl/articles/simd-strfind.html for a detailed description.
+//
+// The reverse searches work the same way, but process the blocks starting
+// from the end of the haystack and the candidates within a block starting
+// from the highest one.
+//
+// All of them require `2 <= m <= n`.
+
+#if defined(BEV_STRING_VIEW_SSE2)
+namespace sse2 {
+
+inline size_t
+find(const char* hay, size_t n, const char* s, size_t m) noexcept
+{
+  const __m128i first = _mm_set1_epi8(s[0]);
+  const __m128i last = _mm_set1_epi8(s[m - 1]);
+  const size_t positions = n - m + 1;
+  size_t i = 0;
+  for (; i + 16 <= positions; i += 16) {
+    const __m128i block_first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i));
+    const __m128i block_last =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i + m - 1));
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                      _mm_cmpeq_epi8(last, block_last))));
+    while (mask) {
+      const size_t pos = i + countr_zero(mask);
+      if (std::memcmp(hay + pos + 1, s + 1, m - 2) == 0)
+        return pos;
+      mask &= mask - 1;
+    }
+  }
+  return scalar::find(hay, n, s, m, i);
+}
+
+inline size_t
+rfind(const char* hay, size_t n, const char* s, size_t m) noexcept
+{
+  const __m128i first = _mm_set1_epi8(s[0]);
+  const __m128i last = _mm_set1_epi8(s[m - 1]);
+  size_t end = n - m + 1;
+  for (; end >= 16; end -= 16) {
+    const size_t i = end - 16;
+    const __m128i block_first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i));
+    const __m128i block_last =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i + m - 1));
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                      _mm_cmpeq_epi8(last, block_last))));
+    while (mask) {
+      const int bit = bit_index_high(mask);
+      if (std::memcmp(hay + i + bit + 1, s + 1, m - 2) == 0)
+        return i + bit;
+      mask ^= uint32_t(1) << bit;
+    }
+  }
+  return scalar::rfind(hay, n, s, m, end);
+}
+
+inline size_t
+rfind(const char* p, size_t n, char c) noexcept
+{
+  const __m128i needle = _mm_set1_epi8(c);
+  for (; n >= 16; n -= 16) {
+    const __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + n - 16));
+    const uint32_t mask = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+    if (mask)
+      return n - 16 + bit_index_high(mask);
+  }
+  return scalar::rfind(p, n, c);
+}
+
+// Requires `n >= 16`. Long ranges are compared 64 bytes at a time with a
+// single `movemask`, and the last block overlaps the previous ones.
+inline bool
+equal(const char* a, const char* b, size_t n) noexcept
+{
+  const auto block_eq = [=](size_t i) {
+    return _mm_cmpeq_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+  };
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    const __m128i eq = _mm_and_si128(
+        _mm_and_si128(block_eq(i), block_eq(i + 16)),
+        _mm_and_si128(block_eq(i + 32), block_eq(i + 48)));
+    if (_mm_movemask_epi8(eq) != 0xffff)
+      return false;
+  }
+  if (i == n)
+    return true;
+  __m128i eq = block_eq(n - 16);
+  for (; i + 16 < n; i += 16)
+    eq = _mm_and_si128(eq, block_eq(i));
+  return _mm_movemask_epi8(eq) == 0xffff;
+}
+
+// Folds 'A' to 'Z' to lowercase. Adding 128 - 'A' moves the uppercase
+// letters to the 26 smallest signed bytes, since SSE2 only has signed
+// comparisons.
+inline __m128i
+fold_case(__m128i v) noexcept
+{
+  const __m128i shifted = _mm_add_epi8(v, _mm_set1_epi8(0x80 - 'A'));
+  const __m128i upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8(-128 + 26));
+  return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+inline int
+ci_compare(const char* a, const char* b, size_t n) noexcept
+{
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i x = fold_case(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+    const __m128i y = fold_case(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+    const uint32_t differ = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(x, y))) ^ 0xffff;
+    if (differ)
+      return scalar::ci_compare(a, b, n, i + countr_zero(differ));
+  }
+  return scalar::ci_compare(a, b, n, i);
+}
+
+// `c` is a lowercase letter, see `scalar::ci_find()`.
+inline size_t
+ci_find(const char* p, size_t n, char c) noexcept
+{
+  const __m128i needle = _mm_set1_epi8(c);
+  const __m128i lower = _mm_set1_epi8(0x20);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_or_si128(block, lower), needle)));
+    if (mask)
+      return i + countr_zero(mask);
+  }
+  return scalar::ci_find(p, n, c, i);
+}
+
+inline bool
+is_ascii(const char* p, size_t n) noexcept
+{
+  __m128i bits = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    bits = _mm_or_si128(
+        bits, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
+  return _mm_movemask_epi8(bits) == 0 && scalar::is_ascii(p, n, i);
+}
+
+} // namespace sse2
+#endif
+
+// The classification kernels look up both nibbles of every byte in the
+// tables of a `byte_class` with a byte shuffle, see
+// http://0x80.pl/articles/simd-byte-lookup.html. All of them require
+// `c.vectorizable` to be true.
+
+#if defined(BEV_STRING_VIEW_SSSE3)
+namespace ssse3 {
+
+// Returns a bitmask with one bit set for every byte of `v` in the class.
+inline uint32_t
+class_mask(__m128i v, __m128i lo, __m128i hi) noexcept
+{
+  const __m128i nibble = _mm_set1_epi8(0x0f);
+  const __m128i l = _mm_shuffle_epi8(lo, _mm_and_si128(v, nibble));
+  const __m128i h = _mm_shuffle_epi8(
+      hi, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+  const __m128i none = _mm_cmpeq_epi8(_mm_and_si128(l, h),
+                                      _mm_setzero_si128());
+  return ~static_cast<uint32_t>(_mm_movemask_epi8(none)) & 0xffff;
+}
+
+template<bool Negate>
+inline size_t
+find_first_of(const char* p, size_t n, const byte_class& c) noexcept
+{
+  const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.lo));
+  const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.hi));
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    uint32_t mask = class_mask(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), lo, hi);
+    if (Negate)
+      mask ^= 0xffff;
+    if (mask)
+      return i + countr_zero(mask);
+  }
+  return scalar::find_first_of<Negate>(p, n, c, i);
+}
+
+template<bool Negate>
+inline size_t
+find_last_of(const char* p, size_t n, const byte_class& c) noexcept
+{
+  const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.lo));
+  const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.hi));
+  for (; n >= 16; n -= 16) {
+    uint32_t mask = class_mask(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + n - 16)), lo, hi);
+    if (Negate)
+      mask ^= 0xffff;
+    if (mask)
+      return n - 16 + bit_index_high(mask);
+  }
+  return scalar::find_last_of<Negate>(p, n, c);
+}
+
+inline uint64_t
+class_bitmask(const char* p, size_t n, const byte_class& c) noexcept
+{
+  if (n < 64)
+    return scalar::class_bitmask(p, n, c);
+  const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.lo));
+  const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.hi));
+  uint64_t mask = 0;
+  for (int i = 0; i < 64; i += 16)
+    mask |= uint64_t(class_mask(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), lo, hi)) << i;
+  return mask;
+}
+
+// The Teddy prefilter classifies the first `Width` bytes of every position
+// like `class_mask()`, with separate tables for each of them, and combines
+// the buckets with an AND.
+template<size_t Width>
+inline size_t
+teddy(const char* p, size_t n, const teddy_masks& t) noexcept
+{
+  const __m128i nibble = _mm_set1_epi8(0x0f);
+  __m128i lo[Width], hi[Width];
+  for (size_t j = 0; j < Width; ++j) {
+    lo[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t.lo[j]));
+    hi[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t.hi[j]));
+  }
+  size_t i = 0;
+  for (; i + 16 + Width - 1 <= n; i += 16) {
+    __m128i buckets = _mm_set1_epi8(-1);
+    for (size_t j = 0; j < Width; ++j) {
+      const __m128i v =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + j));
+      const __m128i l = _mm_shuffle_epi8(lo[j], _mm_and_si128(v, nibble));
+      const __m128i h = _mm_shuffle_epi8(
+          hi[j], _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+      buckets = _mm_and_si128(buckets, _mm_and_si128(l, h));
+    }
+    const uint32_t mask = ~static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(buckets, _mm_setzero_si128()))) & 0xffff;
+    if (mask)
+      return i + countr_zero(mask);
+  }
+  return scalar::teddy(p, n, t, i);
+}
+
+// The error bits of the 16 bytes of `input`, which follow those of `prev`,
+// see `utf8_tables`. The lookups find all errors within pairs of bytes;
+// a continuation byte that is the third or fourth byte of a sequence is only
+// expected because of the lead byte two or three positions before it.
+inline __m128i
+utf8_errors(__m128i input, __m128i prev) noexcept
+{
+  const __m128i nibble = _mm_set1_epi8(0x0f);
+  const auto lookup = [](const uint8_t* table, __m128i index) {
+    return _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(table)), index);
+  };
+  const __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+  const __m128i special = _mm_and_si128(
+      _mm_and_si128(
+          lookup(utf8_lookup.byte_1_high,
+                 _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+          lookup(utf8_lookup.byte_1_low, _mm_and_si128(prev1, nibble))),
+      lookup(utf8_lookup.byte_2_high,
+             _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+  const __m128i third = _mm_subs_epu8(_mm_alignr_epi8(input, prev, 14),
+                                      _mm_set1_epi8(char(0xe0 - 0x80)));
+  const __m128i fourth = _mm_subs_epu8(_mm_alignr_epi8(input, prev, 13),
+                                       _mm_set1_epi8(char(0xf0 - 0x80)));
+  const __m128i expected = _mm_and_si128(_mm_or_si128(third, fourth),
+                                         _mm_set1_epi8(char(0x80)));
+  return _mm_xor_si128(expected, special);
+}
+
+// Blocks of ASCII are skipped unless the block before them ends with an
+// incomplete sequence. The rest after the last full block is checked as a
+// block padded with zeros, which also catches sequences that are cut off at
+// the end.
+inline bool
+utf8_validate(const char* p, size_t n) noexcept
+{
+  const __m128i incomplete_max = _mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(utf8_lookup.incomplete));
+  __m128i prev = _mm_setzero_si128();
+  __m128i incomplete = _mm_setzero_si128();
+  __m128i errors = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i input =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    if (_mm_movemask_epi8(input) == 0) {
+      errors = _mm_or_si128(errors, incomplete);
+    } else {
+      errors = _mm_or_si128(errors, utf8_errors(input, prev));
+      incomplete = _mm_subs_epu8(input, incomplete_max);
+    }
+    prev = input;
+  }
+  alignas(16) char rest[16] = {};
+  std::memcpy(rest, p + i, n - i);
+  errors = _mm_or_si128(errors, utf8_errors(
+      _mm_load_si128(reinterpret_cast<const __m128i*>(rest)), prev));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(errors, _mm_setzero_si128()))
+      == 0xffff;
+}
+
+} // namespace ssse3
+#endif
+
+#if defined(BEV_STRING_VIEW_AVX2)
+namespace avx2 {
+
+inline size_t
+find(const char* hay, size_t n, const char* s, size_t m) noexcept
+{
+  const __m256i first = _mm256_set1_epi8(s[0]);
+  const __m256i last = _mm256_set1_epi8(s[m - 1]);
+  const size_t positions = n - m + 1;
+  size_t i = 0;
+  for (; i + 32 <= positions; i += 32) {
+    const __m256i block_first =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i));
+    const __m256i block_last =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i + m - 1));
+    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first),
+                         _mm256_cmpeq_epi8(last, block_last))));
+    while (mask) {
+      const size_t pos = i + countr_zero(mask);
+      if (std::memcmp(hay + pos + 1, s + 1, m - 2) == 0)
+        return pos;
+      mask &= mask - 1;
+    }
+  }
+  return scalar::find(hay, n, s, m, i);
+}
+
+inline size_t
+rfind(const char* hay, size_t n, const char* s, size_t m) noexcept
+{
+  const __m256i first = _mm256_set1_epi8(s[0]);
+  const __m256i last = _mm256_set1_epi8(s[m - 1]);
+  size_t end = n - m + 1;
+  for (; end >= 32; end -= 32) {
+    const size_t i = end - 32;
+    const __m256i block_first =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i));
+    const __m256i block_last =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i + m - 1));
+    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first),
+                         _mm256_cmpeq_epi8(last, block_last))));
+    while (mask) {
+      const int bit = bit_index_high(mask);
+      if (std::memcmp(hay + i + bit + 1, s + 1, m - 2) == 0)
+        return i + bit;
+      mask ^= uint32_t(1) << bit;
+    }
+  }
+  return scalar::rfind(hay, n, s, m, end);
+}
+
+inline size_t
+rfind(const char* p, size_t n, char c) noexcept
+{
+  const __m256i needle = _mm256_set1_epi8(c);
+  for (; n >= 32; n -= 32) {
+    const __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + n - 32));
+    const uint32_t mask = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+    if (mask)
+      return n - 32 + bit_index_high(mask);
+  }
+  return scalar::rfind(p, n, c);
+}
+
+// Requires `n >= 32`, works like the SSE2 version with 128 bytes at a time.
+inline bool
+equal(const char* a, const char* b, size_t n) noexcept
+{
+  const auto block_eq = [=](size_t i) {
+    return _mm256_cmpeq_epi8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+  };
+  const auto all_set = [](__m256i eq) {
+    return static_cast<uint32_t>(_mm256_movemask_epi8(eq)) == 0xffffffffu;
+  };
+  size_t i = 0;
+  for (; i + 128 <= n; i += 128) {
+    const __m256i eq = _mm256_and_si256(
+        _mm256_and_si256(block_eq(i), block_eq(i + 32)),
+        _mm256_and_si256(block_eq(i + 64), block_eq(i + 96)));
+    if (!all_set(eq))
+      return false;
+  }
+  if (i == n)
+    return true;
+  __m256i eq = block_eq(n - 32);
+  for (; i + 32 < n; i += 32)
+    eq = _mm256_and_si256(eq, block_eq(i));
+  return all_set(eq);
+}
+
+inline uint32_t
+class_mask(__m256i v, __m256i lo, __m256i hi) noexcept
+{
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  const __m256i l = _mm256_shuffle_epi8(lo, _mm256_and_si256(v, nibble));
+  const __m256i h = _mm256_shuffle_epi8(
+      hi, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+  const __m256i none = _mm256_cmpeq_epi8(_mm256_and_si256(l, h),
+                                         _mm256_setzero_si256());
+  return ~static_cast<uint32_t>(_mm256_movemask_epi8(none));
+}
+
+// `_mm256_shuffle_epi8()` works within each 128-bit lane, so the tables need
+// to be present in both of them.
+inline __m256i
+load_table(const uint8_t* table) noexcept
+{
+  return _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+}
+
+template<bool Negate>
+inline size_t
+find_first_of(const char* p, size_t n, const byte_class& c) noexcept
+{
+  const __m256i lo = load_table(c.lo);
+  const __m256i hi = load_table(c.hi);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    uint32_t mask = class_mask(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), lo, hi);
+    if (Negate)
+      mask = ~mask;
+    if (mask)
+      return i + countr_zero(mask);
+  }
+  return scalar::find_first_of<Negate>(p, n, c, i);
+}
+
+template<bool Negate>
+inline size_t
+find_last_of(const char* p, size_t n, const byte_class& c) noexcept
+{
+  const __m256i lo = load_table(c.lo);
+  const __m256i hi = load_table(c.hi);
+  for (; n >= 32; n -= 32) {
+    uint32_t mask = class_mask(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + n - 32)),
+        lo, hi);
+    if (Negate)
+      mask = ~mask;
+    if (mask)
+      return n - 32 + bit_index_high(mask);
+  }
+  return scalar::find_last_of<Negate>(p, n, c);
+}
+
+inline uint64_t
+class_bitmask(const char* p, size_t n, const byte_class& c) noexcept
+{
+  if (n < 64)
+    return scalar::class_bitmask(p, n, c);
+  const __m256i lo = load_table(c.lo);
+  const __m256i hi = load_table(c.hi);
+  const uint32_t low = class_mask(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), lo, hi);
+  const uint32_t high = class_mask(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32)), lo, hi);
+  return uint64_t(high) << 32 | low;
+}
+
+template<size_t Width>
+inline size_t
+teddy(const char* p, size_t n, const teddy_masks& t) noexcept
+{
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  __m256i lo[Width], hi[Width];
+  for (size_t j = 0; j < Width; ++j) {
+    lo[j] = load_table(t.lo[j]);
+    hi[j] = load_table(t.hi[j]);
+  }
+  size_t i = 0;
+  for (; i + 32 + Width - 1 <= n; i += 32) {
+    __m256i buckets = _mm256_set1_epi8(-1);
+    for (size_t j = 0; j < Width; ++j) {
+      const __m256i v =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + j));
+      const __m256i l = _mm256_shuffle_epi8(lo[j], _mm256_and_si256(v, nibble));
+      const __m256i h = _mm256_shuffle_epi8(
+          hi[j], _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+      buckets = _mm256_and_si256(buckets, _mm256_and_si256(l, h));
+    }
+    const uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(buckets, _mm256_setzero_si256())));
+    if (mask)
+      return i + countr_zero(mask);
+  }
+  return scalar::teddy(p, n, t, i);
+}
+
+inline __m256i
+fold_case(__m256i v) noexcept
+{
+  const __m256i shifted = _mm256_add_epi8(v, _mm256_set1_epi8(0x80 - 'A'));
+  const __m256i upper =
+      _mm256_cmpgt_epi8(_mm256_set1_epi8(-128 + 26), shifted);
+  return _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+// The SSE2 versions handle the rest of less than 32 bytes.
+inline int
+ci_compare(const char* a, const char* b, size_t n) noexcept
+{
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i x = fold_case(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+    const __m256i y = fold_case(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+    const uint32_t differ = ~static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+    if (differ)
+      return scalar::ci_compare(a, b, n, i + countr_zero(differ));
+  }
+  return sse2::ci_compare(a + i, b + i, n - i);
+}
+
+inline size_t
+ci_find(const char* p, size_t n, char c) noexcept
+{
+  const __m256i needle = _mm256_set1_epi8(c);
+  const __m256i lower = _mm256_set1_epi8(0x20);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+    const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_or_si256(block, lower), needle)));
+    if (mask)
+      return i + countr_zero(mask);
+  }
+  const size_t ret = sse2::ci_find(p + i, n - i, c);
+  return ret == kernel_npos ? kernel_npos : i + ret;
+}
+
+inline bool
+is_ascii(const char* p, size_t n) noexcept
+{
+  __m256i bits = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32)
+    bits = _mm256_or_si256(
+        bits, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+  return _mm256_movemask_epi8(bits) == 0 && sse2::is_ascii(p + i, n - i);
+}
+
+// Works like the SSSE3 version. The bytes before each lane of `input` come
+// from the other lane or from the upper lane of `prev`.
+template<int N>
+inline __m256i
+prev_bytes(__m256i input, __m256i prev) noexcept
+{
+  return _mm256_alignr_epi8(
+      input, _mm256_permute2x128_si256(prev, input, 0x21), 16 - N);
+}
+
+inline __m256i
+utf8_errors(__m256i input, __m256i prev) noexcept
+{
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  const __m256i prev1 = prev_bytes<1>(input, prev);
+  const __m256i special = _mm256_and_si256(
+      _mm256_and_si256(
+          _mm256_shuffle_epi8(load_table(utf8_lookup.byte_1_high),
+              _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+          _mm256_shuffle_epi8(load_table(utf8_lookup.byte_1_low),
+              _mm256_and_si256(prev1, nibble))),
+      _mm256_shuffle_epi8(load_table(utf8_lookup.byte_2_high),
+          _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+  const __m256i third = _mm256_subs_epu8(prev_bytes<2>(input, prev),
+                                         _mm256_set1_epi8(char(0xe0 - 0x80)));
+  const __m256i fourth = _mm256_subs_epu8(prev_bytes<3>(input, prev),
+                                          _mm256_set1_epi8(char(0xf0 - 0x80)));
+  const __m256i expected = _mm256_and_si256(
+      _mm256_or_si256(third, fourth), _mm256_set1_epi8(char(0x80)));
+  return _mm256_xor_si256(expected, special);
+}
+
+inline bool
+utf8_validate(const char* p, size_t n) noexcept
+{
+  // The incomplete sequences are only those at the end of the upper lane.
+  const __m256i incomplete_max = _mm256_inserti128_si256(
+      _mm256_set1_epi8(char(0xff)),
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf8_lookup.incomplete)),
+      1);
+  __m256i prev = _mm256_setzero_si256();
+  __m256i incomplete = _mm256_setzero_si256();
+  __m256i errors = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i input =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+    if (_mm256_movemask_epi8(input) == 0) {
+      errors = _mm256_or_si256(errors, incomplete);
+    } else {
+      errors = _mm256_or_si256(errors, utf8_errors(input, prev));
+      incomplete = _mm256_subs_epu8(input, incomplete_max);
+    }
+    prev = input;
+  }
+  alignas(32) char rest[32] = {};
+  std::memcpy(rest, p + i, n - i);
+  errors = _mm256_or_si256(errors, utf8_errors(
+      _mm256_load_si256(reinterpret_cast<const __m256i*>(rest)), prev));
+  return _mm256_testz_si256(errors, errors);
+}
+
+} // namespace avx2
+#endif
+
+#if defined(BEV_STRING_VIEW_NEON)
+namespace neon {
+
+// NEON has no equivalent of `movemask`, so narrow each byte of the
+// comparison result to 4 bits instead and keep only the top bit of each.
+inline uint64_t
+match_mask(uint8x16_t v) noexcept
+{
+  const uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(v), 4);
+  return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0)
+      & 0x8888888888888888ull;
+}
+
+inline size_t
+find(const char* hay, size_t n, const char* s, size_t m) noexcept
+{
+  const uint8x16_t first = vdupq_n_u8(static_cast<uint8_t>(s[0]));
+  const uint8x16_t last = vdupq_n_u8(static_cast<uint8_t>(s[m - 1]));
+  const size_t positions = n - m + 1;
+  size_t i = 0;
+  for (; i + 16 <= positions; i += 16) {
+    const uint8x16_t block_first =
+        vld1q_u8(reinterpret_cast<const uint8_t*>(hay + i));
+    const uint8x16_t block_last =
+        vld1q_u8(reinterpret_cast<const uint8_t*>(hay + i + m - 1));
+    uint64_t mask = match_mask(vandq_u8(vceqq_u8(first, block_first),
+                                        vceqq_u8(last, block_last)));
+    while (mask) {
+      const size_t pos = i + (countr_zero(mask) >> 2);
+      if (std::memcmp(hay + pos + 1, s + 1, m - 2) == 0)
+        return pos;
+      mask &= mask - 1;
+    }
+  }
+  return scalar::find(hay, n, s, m, i);
+}
+
+inline size_t
+rfind(const char* hay, size_t n, const char* s, size_t m) noexcept
+{
+  const uint8x16_t first = vdupq_n_u8(static_cast<uint8_t>(s[0]));
+  const uint8x16_t last = vdupq_n_u8(static_cast<uint8_t>(s[m - 1]));
+  size_t end = n - m + 1;
+  for (; end >= 16; end -= 16) {
+    const size_t i = end - 16;
+    const uint8x16_t block_first =
+        vld1q_u8(reinterpret_cast<const uint8_t*>(hay + i));
+    const uint8x16_t block_last =
+        vld1q_u8(reinterpret_cast<const uint8_t*>(hay + i + m - 1));
+    uint64_t mask = match_mask(vandq_u8(vceqq_u8(first, block_first),
+                                        vceqq_u8(last, block_last)));
+    while (mask) {
+      const int bit = bit_index_high(mask);
+      const size_t pos = i + (bit >> 2);
+      if (std::memcmp(hay + pos + 1, s + 1, m - 2) == 0)
+        return pos;
+      mask ^= uint64_t(1) << bit;
+    }
+  }
+  return scalar::rfind(hay, n, s, m, end);
+}
+
+inline size_t
+rfind(const char* p, size_t n, char c) noexcept
+{
+  const uint8x16_t needle = vdupq_n_u8(static_cast<uint8_t>(c));
+  for (; n >= 16; n -= 16) {
+    const uint64_t mask = match_mask(vceqq_u8(
+        vld1q_u8(reinterpret_cast<const uint8_t*>(p + n - 16)), needle));
+    if (mask)
+      return n - 16 + (bit_index_high(mask) >> 2);
+  }
+  return scalar::rfind(p, n, c);
+}
+
+// Requires `n >= 16`, the last block overlaps the previous one.
+inline bool
+equal(const char* a, const char* b, size_t n) noexcept
+{
+  const auto block_equal = [=](size_t i) {
+    const uint8x16_t x = vld1q_u8(reinterpret_cast<const uint8_t*>(a + i));
+    const uint8x16_t y = vld1q_u8(reinterpret_cast<const uint8_t*>(b + i));
+    return vminvq_u8(vceqq_u8(x, y)) == 0xff;
+  };
+  for (size_t i = 0; i + 16 < n; i += 16)
+    if (!block_equal(i))
+      return false;
+  return block_equal(n - 16);
+}
+
+inline uint64_t
+class_mask(uint8x16_t v, uint8x16_t lo, uint8x16_t hi) noexcept
+{
+  const uint8x16_t l = vqtbl1q_u8(lo, vandq_u8(v, vdupq_n_u8(0x0f)));
+  const uint8x16_t h = vqtbl1q_u8(hi, vshrq_n_u8(v, 4));
+  return match_mask(vtstq_u8(l, h));
+}
+
+template<bool Negate>
+inline size_t
+find_first_of(const char* p, size_t n, const byte_class& c) noexcept
+{
+  const uint8x16_t lo = vld1q_u8(c.lo);
+  const uint8x16_t hi = vld1q_u8(c.hi);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    uint64_t mask = class_mask(
+        vld1q_u8(reinterpret_cast<const uint8_t*>(p + i)), lo, hi);
+    if (Negate)
+      mask ^= 0x8888888888888888ull;
+    if (mask)
+      return i + (countr_zero(mask) >> 2);
+  }
+  return scalar::find_first_of<Negate>(p, n, c, i);
+}
+
+template<bool Negate>
+inline size_t
+find_last_of(const char* p, size_t n, const byte_class& c) noexcept
+{
+  const uint8x16_t lo = vld1q_u8(c.lo);
+  const uint8x16_t hi = vld1q_u8(c.hi);
+  for (; n >= 16; n -= 16) {
+    uint64_t mask = class_mask(
+        vld1q_u8(reinterpret_cast<const uint8_t*>(p + n - 16)), lo, hi);
+    if (Negate)
+      mask ^= 0x8888888888888888ull;
+    if (mask)
+      return n - 16 + (bit_index_high(mask) >> 2);
+  }
+  return scalar::find_last_of<Negate>(p, n, c);
+}
+
+// Gathers one bit per byte of four comparison results by weighting the bytes
+// with their bit and adding them up pairwise.
+inline uint64_t
+class_bitmask(const char* p, size_t n, const byte_class& c) noexcept
+{
+  if (n < 64)
+    return scalar::class_bitmask(p, n, c);
+  const uint8x16_t lo = vld1q_u8(c.lo);
+  const uint8x16_t hi = vld1q_u8(c.hi);
+  static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                      1, 2, 4, 8, 16, 32, 64, 128};
+  const uint8x16_t bits = vld1q_u8(weights);
+  uint8x16_t in_class[4];
+  for (int i = 0; i < 4; ++i) {
+    const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p + 16 * i));
+    const uint8x16_t l = vqtbl1q_u8(lo, vandq_u8(v, vdupq_n_u8(0x0f)));
+    const uint8x16_t h = vqtbl1q_u8(hi, vshrq_n_u8(v, 4));
+    in_class[i] = vandq_u8(vtstq_u8(l, h), bits);
+  }
+  uint8x16_t sum = vpaddq_u8(vpaddq_u8(in_class[0], in_class[1]),
+                             vpaddq_u8(in_class[2], in_class[3]));
+  sum = vpaddq_u8(sum, sum);
+  return vgetq_lane_u64(vreinterpretq_u64_u8(sum), 0);
+}
+
+template<size_t Width>
+inline size_t
+teddy(const char* p, size_t n, const teddy_masks& t) noexcept
+{
+  uint8x16_t lo[Width], hi[Width];
+  for (size_t j = 0; j < Width; ++j) {
+    lo[j] = vld1q_u8(t.lo[j]);
+    hi[j] = vld1q_u8(t.hi[j]);
+  }
+  size_t i = 0;
+  for (; i + 16 + Width - 1 <= n; i += 16) {
+    uint8x16_t buckets = vdupq_n_u8(0xff);
+    for (size_t j = 0; j < Width; ++j) {
+      const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p + i + j));
+      const uint8x16_t l = vqtbl1q_u8(lo[j], vandq_u8(v, vdupq_n_u8(0x0f)));
+      const uint8x16_t h = vqtbl1q_u8(hi[j], vshrq_n_u8(v, 4));
+      buckets = vandq_u8(buckets, vandq_u8(l, h));
+    }
+    const uint64_t mask = match_mask(vtstq_u8(buckets, buckets));
+    if (mask)
+      return i + (countr_zero(mask) >> 2);
+  }
+  return scalar::teddy(p, n, t, i);
+}
+
+inline uint8x16_t
+fold_case(uint8x16_t v) noexcept
+{
+  const uint8x16_t upper =
+      vcltq_u8(vsubq_u8(v, vdupq_n_u8('A')), vdupq_n_u8(26));
+  return vorrq_u8(v, vandq_u8(upper, vdupq_n_u8(0x20)));
+}
+
+inline int
+ci_compare(const char* a, const char* b, size_t n) noexcept
+{
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const uint8x16_t x =
+        fold_case(vld1q_u8(reinterpret_cast<const uint8_t*>(a + i)));
+    const uint8x16_t y =
+        fold_case(vld1q_u8(reinterpret_cast<const uint8_t*>(b + i)));
+    const uint64_t differ =
+        match_mask(vceqq_u8(x, y)) ^ 0x8888888888888888ull;
+    if (differ)
+      return scalar::ci_compare(a, b, n, i + (countr_zero(differ) >> 2));
+  }
+  return scalar::ci_compare(a, b, n, i);
+}
+
+inline size_t
+ci_find(const char* p, size_t n, char c) noexcept
+{
+  const uint8x16_t needle = vdupq_n_u8(static_cast<uint8_t>(c));
+  const uint8x16_t lower = vdupq_n_u8(0x20);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(p + i));
+    const uint64_t mask = match_mask(vceqq_u8(vorrq_u8(block, lower), needle));
+    if (mask)
+      return i + (countr_zero(mask) >> 2);
+  }
+  return scalar::ci_find(p, n, c, i);
+}
+
+inline bool
+is_ascii(const char* p, size_t n) noexcept
+{
+  uint8x16_t bits = vdupq_n_u8(0);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    bits = vorrq_u8(bits, vld1q_u8(reinterpret_cast<const uint8_t*>(p + i)));
+  return vmaxvq_u8(bits) < 0x80 && scalar::is_ascii(p, n, i);
+}
+
+// Works like the SSSE3 version.
+inline uint8x16_t
+utf8_errors(uint8x16_t input, uint8x16_t prev) noexcept
+{
+  const uint8x16_t nibble = vdupq_n_u8(0x0f);
+  const uint8x16_t prev1 = vextq_u8(prev, input, 15);
+  const uint8x16_t special = vandq_u8(
+      vandq_u8(vqtbl1q_u8(vld1q_u8(utf8_lookup.byte_1_high),
+                          vshrq_n_u8(prev1, 4)),
+               vqtbl1q_u8(vld1q_u8(utf8_lookup.byte_1_low),
+                          vandq_u8(prev1, nibble))),
+      vqtbl1q_u8(vld1q_u8(utf8_lookup.byte_2_high), vshrq_n_u8(input, 4)));
+  const uint8x16_t third =
+      vqsubq_u8(vextq_u8(prev, input, 14), vdupq_n_u8(0xe0 - 0x80));
+  const uint8x16_t fourth =
+      vqsubq_u8(vextq_u8(prev, input, 13), vdupq_n_u8(0xf0 - 0x80));
+  const uint8x16_t expected =
+      vandq_u8(vorrq_u8(third, fourth), vdupq_n_u8(0x80));
+  return veorq_u8(expected, special);
+}
+
+inline bool
+utf8_validate(const char* p, size_t n) noexcept
+{
+  const uint8x16_t incomplete_max = vld1q_u8(utf8_lookup.incomplete);
+  uint8x16_t prev = vdupq_n_u8(0);
+  uint8x16_t incomplete = vdupq_n_u8(0);
+  uint8x16_t errors = vdupq_n_u8(0);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const uint8x16_t input =
+        vld1q_u8(reinterpret_cast<const uint8_t*>(p + i));
+    if (vmaxvq_u8(input) < 0x80) {
+      errors = vorrq_u8(errors, incomplete);
+    } else {
+      errors = vorrq_u8(errors, utf8_errors(input, prev));
+      incomplete = vqsubq_u8(input, incomplete_max);
+    }
+    prev = input;
+  }
+  uint8_t rest[16] = {};
+  std::memcpy(rest, p + i, n - i);
+  errors = vorrq_u8(errors, utf8_errors(vld1q_u8(rest), prev));
+  return vmaxvq_u8(errors) == 0;
+}
+
+} // namespace neon
+#endif
+
+// Returns the offset of the first occurrence of the needle `s` of length `m`
+// in `hay`, or `kernel_npos`. Requires `1 <= m <= n`.
+inline size_t
+find_kernel(const char* hay, size_t n, const char* s, size_t m) noexcept
+{
+  if (m == 1) {
+    const void* p = std::memchr(hay, s[0], n);
+    return p ? static_cast<const char*>(p) - hay : kernel_npos;
+  }
+#if defined(BEV_STRING_VIEW_AVX2)
+  return avx2::find(hay, n, s, m);
+#elif defined(BEV_STRING_VIEW_SSE2)
+  return sse2::find(hay, n, s, m);
+#elif defined(BEV_STRING_VIEW_NEON)
+  return neon::find(hay, n, s, m);
+#else
+  return scalar::find(hay, n, s, m);
+#endif
+}
+
+// Returns the offset of the last occurrence of `c` in the first `n` bytes
+// of `p`, or `kernel_npos`.
+inline size_t
+rfind_kernel(const char* p, size_t n, char c) noexcept
+{
+#if defined(BEV_STRING_VIEW_HAS_MEMRCHR)
+  const void* r = ::memrchr(p, c, n);
+  return r ? static_cast<const char*>(r) - p : kernel_npos;
+#elif defined(BEV_STRING_VIEW_AVX2)
+  return avx2::rfind(p, n, c);
+#elif defined(BEV_STRING_VIEW_SSE2)
+  return sse2::rfind(p, n, c);
+#elif defined(BEV_STRING_VIEW_NEON)
+  return neon::rfind(p, n, c);
+#else
+  return scalar::rfind(p, n, c);
+#endif
+}
+
+// Returns the offset of the last occurrence of the needle `s` of length `m`
+// in `hay`, or `kernel_npos`. Requires `1 <= m <= n`.
+inline size_t
+rfind_kernel(const char* hay, size_t n, const char* s, size_t m) noexcept
+{
+  if (m == 1)
+    return rfind_kernel(hay, n, s[0]);
+#if defined(BEV_STRING_VIEW_AVX2)
+  return avx2::rfind(hay, n, s, m);
+#elif defined(BEV_STRING_VIEW_SSE2)
+  return sse2::rfind(hay, n, s, m);
+#elif defined(BEV_STRING_VIEW_NEON)
+  return neon::rfind(hay, n, s, m);
+#else
+  return scalar::rfind(hay, n, s, m, n - m + 1);
+#endif
+}
+
+// Whether the first `n` bytes of `a` and `b` are equal. Short ranges, which
+// are the common case for keys, are compared without entering a loop.
+inline bool
+equal_kernel(const char* a, const char* b, size_t n) noexcept
+{
+  if (n <= 16)
+    return scalar::equal(a, b, n);
+#if defined(BEV_STRING_VIEW_AVX2)
+  if (n >= 32)
+    return avx2::equal(a, b, n);
+  return sse2::equal(a, b, n);
+#elif defined(BEV_STRING_VIEW_SSE2)
+  // Past a few blocks `memcmp()` is faster, since glibc dispatches it at
+  // runtime to the widest vectors that the CPU supports.
+  if (n > 64)
+    return std::memcmp(a, b, n) == 0;
+  return sse2::equal(a, b, n);
+#elif defined(BEV_STRING_VIEW_NEON)
+  return neon::equal(a, b, n);
+#else
+  return scalar::equal(a, b, n);
+#endif
+}
+
+// Returns the offset of the first byte in `p` that is in the class `c` (or
+// not in it, if `Negate` is true), or `kernel_npos`.
+template<bool Negate>
+inline size_t
+find_first_of_kernel(const char* p, size_t n, const byte_class& c) noexcept
+{
+#if defined(BEV_STRING_VIEW_AVX2)
+  if (c.vectorizable)
+    return avx2::find_first_of<Negate>(p, n, c);
+#elif defined(BEV_STRING_VIEW_SSSE3)
+  if (c.vectorizable)
+    return ssse3::find_first_of<Negate>(p, n, c);
+#elif defined(BEV_STRING_VIEW_NEON)
+  if (c.vectorizable)
+    return neon::find_first_of<Negate>(p, n, c);
+#endif
+  return scalar::find_first_of<Negate>(p, n, c);
+}
+
+// Returns the offset of the last byte in `p` that is in the class `c` (or
+// not in it, if `Negate` is true), or `kernel_npos`.
+template<bool Negate>
+inline size_t
+find_last_of_kernel(const char* p, size_t n, const byte_class& c) noexcept
+{
+#if defined(BEV_STRING_VIEW_AVX2)
+  if (c.vectorizable)
+    return avx2::find_last_of<Negate>(p, n, c);
+#elif defined(BEV_STRING_VIEW_SSSE3)
+  if (c.vectorizable)
+    return ssse3::find_last_of<Negate>(p, n, c);
+#elif defined(BEV_STRING_VIEW_NEON)
+  if (c.vectorizable)
+    return neon::find_last_of<Negate>(p, n, c);
+#endif
+  return scalar::find_last_of<Negate>(p, n, c);
+}
+
+// Returns the first position in `p` that is a candidate for a bucket of `t`,
+// or `kernel_npos`.
+inline size_t
+teddy_kernel(const char* p, size_t n, const teddy_masks& t) noexcept
+{
+#if defined(BEV_STRING_VIEW_AVX2)
+  namespace isa = avx2;
+#elif defined(BEV_STRING_VIEW_SSSE3)
+  namespace isa = ssse3;
+#elif defined(BEV_STRING_VIEW_NEON)
+  namespace isa = neon;
+#endif
+#if defined(BEV_STRING_VIEW_SSSE3) || defined(BEV_STRING_VIEW_NEON)
+  switch (t.width) {
+  case 1: return isa::teddy<1>(p, n, t);
+  case 2: return isa::teddy<2>(p, n, t);
+  case 3: return isa::teddy<3>(p, n, t);
+  }
+#endif
+  return scalar::teddy(p, n, t);
+}
+
+// Returns a bitmask of the bytes in the class `c`, for the first
+// `min(n, 64)` bytes of `p`.
+inline uint64_t
+class_bitmask_kernel(const char* p, size_t n, const byte_class& c) noexcept
+{
+#if defined(BEV_STRING_VIEW_AVX2)
+  if (c.vectorizable)
+    return avx2::class_bitmask(p, n, c);
+#elif defined(BEV_STRING_VIEW_SSSE3)
+  if (c.vectorizable)
+    return ssse3::class_bitmask(p, n, c);
+#elif defined(BEV_STRING_VIEW_NEON)
+  if (c.vectorizable)
+    return neon::class_bitmask(p, n, c);
+#endif
+  return scalar::class_bitmask(p, n, c);
+}
+
+// Compares the first `n` bytes of `a` and `b` like `memcmp()`, after folding
+// 'A' to 'Z' to lowercase.
+inline int
+ci_compare_kernel(const char* a, const char* b, size_t n) noexcept
+{
+#if defined(BEV_STRING_VIEW_AVX2)
+  return avx2::ci_compare(a, b, n);
+#elif defined(BEV_STRING_VIEW_SSE2)
+  return sse2::ci_compare(a, b, n);
+#elif defined(BEV_STRING_VIEW_NEON)
+  return neon::ci_compare(a, b, n);
+#else
+  return scalar::ci_compare(a, b, n);
+#endif
+}
+
+// Returns the offset of the first byte in `p` that is equal to `c` after
+// case folding, or `kernel_npos`.
+inline size_t
+ci_find_kernel(const char* p, size_t n, char c) noexcept
+{
+  const char lower = fold_ascii_case(c);
+  if (static_cast<unsigned char>(lower - 'a') >= 26) {
+    const void* r = std::memchr(p, c, n);
+    return r ? static_cast<const char*>(r) - p : kernel_npos;
+  }
+#if defined(BEV_STRING_VIEW_AVX2)
+  return avx2::ci_find(p, n, lower);
+#elif defined(BEV_STRING_VIEW_SSE2)
+  return sse2::ci_find(p, n, lower);
+#elif defined(BEV_STRING_VIEW_NEON)
+  return neon::ci_find(p, n, lower);
+#else
+  return scalar::ci_find(p, n, lower);
+#endif
+}
+
+// Whether all of the `n` bytes at `p` are ASCII.
+inline bool
+is_ascii_kernel(const char* p, size_t n) noexcept
+{
+#if defined(BEV_STRING_VIEW_AVX2)
+  return avx2::is_ascii(p, n);
+#elif defined(BEV_STRING_VIEW_SSE2)
+  return sse2::is_ascii(p, n);
+#elif defined(BEV_STRING_VIEW_NEON)
+  return neon::is_ascii(p, n);
+#else
+  return scalar::is_ascii(p, n);
+#endif
+}
+
+// Whether the `n` bytes at `p` are valid UTF-8. Without byte shuffles this
+// decodes one sequence at a time.
+inline bool
+utf8_validate_kernel(const char* p, size_t n) noexcept
+{
+#if defined(BEV_STRING_VIEW_AVX2)
+  return avx2::utf8_validate(p, n);
+#elif defined(BEV_STRING_VIEW_SSSE3)
+  return ssse3::utf8_validate(p, n);
+#elif defined(BEV_STRING_VIEW_NEON)
+  return neon::utf8_validate(p, n);
+#else
+  return scalar::utf8_validate(p, n);
+#endif
+}
+
+// The kernels above, in the form used by the runtime dispatch.
+inline constexpr kernel_table table = {
+  isa_level::BEV_STRING_VIEW_ISA_LEVEL,
+  &find_kernel,
+  &rfind_kernel,
+  &rfind_kernel,
+  &find_first_of_kernel<false>,
+  &find_first_of_kernel<true>,
+  &find_last_of_kernel<false>,
+  &find_last_of_kernel<true>,
+  &equal_kernel,
+  &teddy_kernel,
+  &class_bitmask_kernel,
+  &ci_compare_kernel,
+  &ci_find_kernel,
+  &is_ascii_kernel,
+  &utf8_validate_kernel,
+};
+
+} // namespace BEV_STRING_VIEW_ISA_NAMESPACE
+
+namespace scalar = BEV_STRING_VIEW_ISA_NAMESPACE::scalar;
+using BEV_STRING_VIEW_ISA_NAMESPACE::countr_zero;
+
+// The entry points used by `basic_string_view`.
+
+#if defined(BEV_STRING_VIEW_RUNTIME_DISPATCH)
+
+// The kernels selected for the CPU, defined by the `bev::string_view_simd`
+// library. The short cases that don't need any vector instructions stay
+// inline, to avoid the indirect call.
+extern std::atomic<const kernel_table*> active_kernels;
+
+inline const kernel_table&
+active_table() noexcept
+{ return *active_kernels.load(std::memory_order_relaxed); }
+
+inline size_t
+find_kernel(const char* hay, size_t n, const char* s, size_t m) noexcept
+{
+  if (m == 1)
+    return BEV_STRING_VIEW_ISA_NAMESPACE::find_kernel(hay, n, s, m);
+  return active_table().find(hay, n, s, m);
+}
+
+inline size_t
+rfind_kernel(const char* p, size_t n, char c) noexcept
+{
+#if defined(BEV_STRING_VIEW_HAS_MEMRCHR)
+  return BEV_STRING_VIEW_ISA_NAMESPACE::rfind_kernel(p, n, c);
+#else
+  return active_table().rfind_char(p, n, c);
+#endif
+}
+
+inline size_t
+rfind_kernel(const char* hay, size_t n, const char* s, size_t m) noexcept
+{
+  if (m == 1)
+    return rfind_kernel(hay, n, s[0]);
+  return active_table().rfind(hay, n, s, m);
+}
+
+template<bool Negate>
+inline size_t
+find_first_of_kernel(const char* p, size_t n, const byte_class& c) noexcept
+{
+  const kernel_table& table = active_table();
+  return Negate ? table.find_first_not_of(p, n, c)
+                : table.find_first_of(p, n, c);
+}
+
+template<bool Negate>
+inline size_t
+find_last_of_kernel(const char* p, size_t n, const byte_class& c) noexcept
+{
+  const kernel_table& table = active_table();
+  return Negate ? table.find_last_not_of(p, n, c)
+                : table.find_last_of(p, n, c);
+}
+
+inline bool
+equal_kernel(const char* a, const char* b, size_t n) noexcept
+{
+  if (n <= 16)
+    return scalar::equal(a, b, n);
+  return active_table().equal(a, b, n);
+}
+
+inline size_t
+teddy_kernel(const char* p, size_t n, const teddy_masks& t) noexcept
+{ return active_table().teddy(p, n, t); }
+
+inline uint64_t
+class_bitmask_kernel(const char* p, size_t n, const byte_class& c) noexcept
+{ return active_table().class_bitmask(p, n, c); }
+
+inline int
+ci_compare_kernel(const char* a, const char* b, size_t n) noexcept
+{
+  if (n < 16)
+    return scalar::ci_compare(a, b, n);
+  return active_table().ci_compare(a, b, n);
+}
+
+inline size_t
+ci_find_kernel(const char* p, size_t n, char c) noexcept
+{ return active_table().ci_find(p, n, c); }
+
+inline bool
+is_ascii_kernel(const char* p, size_t n) noexcept
+{
+  if (n < 16)
+    return scalar::is_ascii(p, n);
+  return active_table().is_ascii(p, n);
+}
+
+inline bool
+utf8_validate_kernel(const char* p, size_t n) noexcept
+{ return active_table().utf8_validate(p, n); }
+
+#else
+
+using BEV_STRING_VIEW_ISA_NAMESPACE::find_kernel;
+using BEV_STRING_VIEW_ISA_NAMESPACE::rfind_kernel;
+using BEV_STRING_VIEW_ISA_NAMESPACE::find_first_of_kernel;
+using BEV_STRING_VIEW_ISA_NAMESPACE::find_last_of_kernel;
+using BEV_STRING_VIEW_ISA_NAMESPACE::equal_kernel;
+using BEV_STRING_VIEW_ISA_NAMESPACE::teddy_kernel;
+using BEV_STRING_VIEW_ISA_NAMESPACE::class_bitmask_kernel;
+using BEV_STRING_VIEW_ISA_NAMESPACE::ci_compare_kernel;
+using BEV_STRING_VIEW_ISA_NAMESPACE::ci_find_kernel;
+using BEV_STRING_VIEW_ISA_NAMESPACE::is_ascii_kernel;
+using BEV_STRING_VIEW_ISA_NAMESPACE::utf8_validate_kernel;
+
+#endif
+
+} // namespace detail
+} // namespace bev
@@ -0,0 +1,29 @@
+// Formatting of views with {fmt}, which copies their characters directly
+// from the view, without a conversion to `std::string`:
+//
+//     #include <bev/fmt.hpp>
+//
+//     fmt::print("{:>12}: {}\n", key, value);
+//
+// Views with any traits are formatted like `fmt::basic_string_view`, with
+// the same format specifications. Requires {fmt} 9 or later.
+
+#pragma once
+
+#include <bev/string_view.hpp>
+
+#include <fmt/format.h>
+
+template<typename CharT, typename Traits>
+struct fmt::formatter<bev::basic_string_view<CharT, Traits>, CharT>
+  : fmt::formatter<fmt::basic_string_view<CharT>, CharT>
+{
+  template<typename FormatContext>
+  auto
+  format(bev::basic_string_view<CharT, Traits> str, FormatContext& ctx) const
+      -> decltype(ctx.out())
+  {
+    return fmt::formatter<fmt::basic_string_view<CharT>, CharT>::format(
+        fmt::basic_string_view<CharT>{str.data(), str.size()}, ctx);
+  }
+};
@@ -0,0 +1,228 @@
+// A `bev::basic_string_view` together with its precomputed hash value, for
+// keys that are looked up repeatedly in one or more hash tables.
+//
+// The transparent functors `bev::transparent_hash` and
+// `bev::transparent_equal_to` allow looking up hashed views in containers
+// keyed by `std::string` without hashing the bytes again:
+//
+//     std::unordered_map<std::string, int,
+//                        bev::transparent_hash, std::equal_to<>> map;
+//     bev::hashed_string_view key{"content-length"};
+//     auto it = map.find(key);
+//
+// Note that heterogeneous lookup in the unordered containers requires C++20.
+
+#pragma once
+
+#include <bev/string_view.hpp>
+
+namespace bev {
+
+  /**
+   *  @brief  A basic_string_view with a cached hash value.
+   *
+   *  @tparam CharT      Type of character
+   *  @tparam Traits     Traits for character type
+   *  @tparam Algorithm  The hash algorithm, see `bev::hash`
+   *
+   *  Stores the view itself, so the safederef flag is preserved, and the
+   *  64-bit hash computed by `bev::hash<Algorithm>::hash64()`, which is
+   *  not truncated to `size_t` on 32-bit platforms. Comparing two hashed
+   *  views compares the hash values before comparing the bytes.
+   */
+template<typename CharT, typename Traits = std::char_traits<CharT>,
+         typename Algorithm = default_hash_algorithm>
+class basic_hashed_string_view
+{
+public:
+  using view_type      = basic_string_view<CharT, Traits>;
+  using algorithm_type = Algorithm;
+  using size_type      = typename view_type::size_type;
+
+  constexpr
+  basic_hashed_string_view() noexcept
+    : basic_hashed_string_view{view_type{}}
+  { }
+
+  constexpr explicit
+  basic_hashed_string_view(view_type sv) noexcept
+    : view_{sv}, hash_{bev::hash<Algorithm>::hash64(sv)}
+  { }
+
+  // Constructs a hashed view from a hash value computed earlier, which must
+  // be identical to `bev::hash<Algorithm>::hash64(sv)`.
+  constexpr
+  basic_hashed_string_view(view_type sv, uint64_t hash_value) noexcept
+    : view_{sv}, hash_{hash_value}
+  { }
+
+  constexpr
+  operator view_type() const noexcept
+  { return view_; }
+
+  constexpr view_type
+  view() const noexcept
+  { return view_; }
+
+  constexpr uint64_t
+  hash() const noexcept
+  { return hash_; }
+
+  constexpr const CharT*
+  data() const noexcept
+  { return view_.data(); }
+
+  constexpr size_type
+  size() const noexcept
+  { return view_.size(); }
+
+  constexpr size_type
+  length() const noexcept
+  { return view_.length(); }
+
+  [[nodiscard]] constexpr bool
+  empty() const noexcept
+  { return view_.empty(); }
+
+  bool
+  is_cstring() const
+  { return view_.is_cstring(); }
+
+private:
+  view_type view_;
+  uint64_t hash_;
+};
+
+template<typename CharT, typename Traits, typename Algorithm>
+constexpr bool
+operator==(const basic_hashed_string_view<CharT, Traits, Algorithm>& x,
+           const basic_hashed_string_view<CharT, Traits, Algorithm>& y) noexcept
+{ return x.hash() == y.hash() && x.view() == y.view(); }
+
+template<typename CharT, typename Traits, typename Algorithm>
+constexpr bool
+operator==(const basic_hashed_string_view<CharT, Traits, Algorithm>& x,
+           detail::identity<basic_string_view<CharT, Traits>> y) noexcept
+{ return x.view() == y; }
+
+template<typename CharT, typename Traits, typename Algorithm>
+constexpr bool
+operator==(detail::identity<basic_string_view<CharT, Traits>> x,
+           const basic_hashed_string_view<CharT, Traits, Algorithm>& y) noexcept
+{ return x == y.view(); }
+
+template<typename CharT, typename Traits, typename Algorithm>
+constexpr bool
+operator!=(const basic_hashed_string_view<CharT, Traits, Algorithm>& x,
+           const basic_hashed_string_view<CharT, Traits, Algorithm>& y) noexcept
+{ return !(x == y); }
+
+template<typename CharT, typename Traits, typename Algorithm>
+constexpr bool
+operator!=(const basic_hashed_string_view<CharT, Traits, Algorithm>& x,
+           detail::identity<basic_string_view<CharT, Traits>> y) noexcept
+{ return !(x == y); }
+
+template<typename CharT, typename Traits, typename Algorithm>
+constexpr bool
+operator!=(detail::identity<basic_string_view<CharT, Traits>> x,
+           const basic_hashed_string_view<CharT, Traits, Algorithm>& y) noexcept
+{ return !(x == y); }
+
+using hashed_string_view = basic_hashed_string_view<char>;
+
+// Hashed view literal. The hash is computed at compile time in C++20, and in
+// constant expressions before that, so it can be used to dispatch on the
+// hash of a string in a `switch` statement:
+//
+//     switch (key.hash()) {
+//     case "GET"_hsv.hash(): ...
+//     }
+#if defined(__cpp_consteval)
+inline consteval basic_hashed_string_view<char>
+#else
+inline constexpr basic_hashed_string_view<char>
+#endif
+operator""_hsv(const char* str, size_t len) noexcept
+{
+  return basic_hashed_string_view<char>{
+      basic_string_view<char>{str, len, safederef}};
+}
+
+// [hashed.string.view.functors], transparent functors
+
+  /**
+   *  @brief  A transparent hash functor for string keys.
+   *
+   *  Hashes `std::string`, `bev::string_view` and `const char*` with
+   *  `bev::hash<Algorithm>`, and returns the cached value for hashed views.
+   *  Only takes hashed views with the default traits, since the hashes of
+   *  other traits, e.g. case-insensitive ones, differ from those of the
+   *  same bytes as `std::string`.
+   */
+template<typename Algorithm = default_hash_algorithm>
+struct basic_transparent_hash
+{
+  using is_transparent = void;
+
+  constexpr size_t
+  operator()(basic_string_view<char> sv) const noexcept
+  { return hash<Algorithm>{}(sv); }
+
+  size_t
+  operator()(const std::string& s) const noexcept
+  { return hash<Algorithm>{}(basic_string_view<char>{s}); }
+
+  constexpr size_t
+  operator()(const char* s) const noexcept
+  { return hash<Algorithm>{}(basic_string_view<char>{s}); }
+
+  constexpr size_t
+  operator()(const basic_hashed_string_view<char, std::char_traits<char>,
+                                          Algorithm>& s) const noexcept
+  { return static_cast<size_t>(s.hash()); }
+};
+
+  /**
+   *  @brief  A transparent equality functor for string keys.
+   *
+   *  Compares the hash values first if both arguments are hashed views, and
+   *  the bytes otherwise. Like `basic_transparent_hash`, only takes hashed
+   *  views with the default traits.
+   */
+struct transparent_equal_to
+{
+  using is_transparent = void;
+
+  template<typename Algorithm>
+  constexpr bool
+  operator()(
+      const basic_hashed_string_view<char, std::char_traits<char>, Algorithm>& x,
+      const basic_hashed_string_view<char, std::char_traits<char>, Algorithm>& y)
+    const noexcept
+  { return x == y; }
+
+  template<typename T, typename U, typename = std::enable_if_t<
+      std::is_constructible_v<basic_string_view<char>, const T&>
+      && std::is_constructible_v<basic_string_view<char>, const U&>>>
+  constexpr bool
+  operator()(const T& x, const U& y) const noexcept
+  { return basic_string_view<char>(x) == basic_string_view<char>(y); }
+};
+
+using transparent_hash = basic_transparent_hash<>;
+
+} // namespace bev
+
+namespace std {
+
+template<typename CharT, typename Traits, typename Algorithm>
+struct hash<bev::basic_hashed_string_view<CharT, Traits, Algorithm>>
+{
+  constexpr size_t
+  operator()(const bev::basic_hashed_string_view<CharT, Traits, Algorithm>& s)
+    const noexcept
+  { return static_cast<size_t>(s.hash()); }
+};
+
+} // namespace std
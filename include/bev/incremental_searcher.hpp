@@ -0,0 +1,157 @@
+// A searcher that finds a needle in a stream that arrives in chunks, keeping
+// its state across chunks instead of searching the accumulated data again:
+//
+//     bev::incremental_searcher end_of_head{"\r\n\r\n"};
+//     ssize_t n;
+//     while ((n = read(fd, buf, sizeof(buf))) > 0) {
+//       size_t pos = end_of_head.feed(bev::string_view(buf, n));
+//       if (pos != bev::incremental_searcher::npos)
+//         return parse_head(pos);
+//     }
+//
+// Every chunk is first searched with `basic_string_view::find()`, and the
+// Knuth-Morris-Pratt automaton only runs over the bytes that can be part of
+// a match that spans a chunk boundary: at most `needle.size() - 1` bytes at
+// the start and at the end of each chunk. So apart from these, each byte is
+// examined only once, by the vectorized search kernels.
+
+#pragma once
+
+#include <bev/string_view.hpp>
+
+#include <memory>
+#include <stdexcept>
+
+namespace bev {
+
+  /**
+   *  @brief  A resumable search for a needle in a chunked stream.
+   *
+   *  @tparam CharT   Type of character
+   *  @tparam Traits  Traits for character type
+   *
+   *  Offsets are relative to the start of the stream, i.e. to the first
+   *  character passed to `feed()` since construction or the last `reset()`.
+   *  The needle is not copied and has to outlive the searcher.
+   */
+template<typename CharT, typename Traits = std::char_traits<CharT>>
+class basic_incremental_searcher
+{
+public:
+  using view_type   = basic_string_view<CharT, Traits>;
+  using traits_type = Traits;
+  using size_type   = size_t;
+
+  static constexpr size_type npos = size_type(-1);
+
+  // Throws `std::invalid_argument` if the needle is empty.
+  explicit
+  basic_incremental_searcher(view_type needle)
+    : needle_{needle}, failure_{new size_type[needle.size()]}
+  {
+    if (needle.empty())
+      throw std::invalid_argument("incremental_searcher: empty needle");
+    // failure_[q] is the length of the longest proper prefix of the needle
+    // that is also a suffix of its first `q + 1` characters.
+    failure_[0] = 0;
+    for (size_type q = 1, k = 0; q < needle.size(); ++q) {
+      while (k > 0 && !traits_type::eq(needle[q], needle[k]))
+        k = failure_[k - 1];
+      if (traits_type::eq(needle[q], needle[k]))
+        ++k;
+      failure_[q] = k;
+    }
+  }
+
+  // Feeds the next chunk of the stream, and returns the offset of the first
+  // match that ends in it or `npos`. The whole chunk is consumed, so later
+  // matches that end in the same chunk are skipped.
+  size_type
+  feed(view_type chunk)
+  {
+    size_type first = npos;
+    this->feed(chunk, [&first](size_type pos) {
+      if (first == npos)
+        first = pos;
+    });
+    return first;
+  }
+
+  // Feeds the next chunk of the stream, and calls `on_match` with the offset
+  // of every match that ends in it, in increasing order and including
+  // overlapping matches.
+  template<typename Callback>
+  void
+  feed(view_type chunk, Callback on_match)
+  {
+    const size_type m = needle_.size();
+    size_type i = 0;
+
+    // Continue a partial match from the previous chunks, until it either
+    // fails or the partial match starts within this chunk.
+    while (state_ > i && i < chunk.size()) {
+      this->step(chunk[i++]);
+      if (state_ == m) {
+        on_match(position_ + i - m);
+        state_ = failure_[m - 1];
+      }
+    }
+
+    if (state_ <= i) {
+      size_type from = i - state_;
+      for (;;) {
+        const size_type ret = chunk.find(needle_, from);
+        if (ret == view_type::npos)
+          break;
+        on_match(position_ + ret);
+        from = ret + 1;
+      }
+      // Only the last `m - 1` characters can start a partial match, and
+      // none of them completes one.
+      state_ = 0;
+      for (i = std::max(from, chunk.size() >= m ? chunk.size() - m + 1 : 0);
+           i < chunk.size(); ++i)
+        this->step(chunk[i]);
+    }
+    position_ += chunk.size();
+  }
+
+  // Forgets all previous input and starts a new stream.
+  void
+  reset() noexcept
+  {
+    position_ = 0;
+    state_ = 0;
+  }
+
+  // The number of characters fed since the start of the stream.
+  size_type
+  position() const noexcept
+  { return position_; }
+
+  view_type
+  needle() const noexcept
+  { return needle_; }
+
+private:
+  void
+  step(CharT c) noexcept
+  {
+    while (state_ > 0 && !traits_type::eq(needle_[state_], c))
+      state_ = failure_[state_ - 1];
+    if (traits_type::eq(needle_[state_], c))
+      ++state_;
+  }
+
+  view_type needle_;
+  std::unique_ptr<size_type[]> failure_;
+  size_type position_ = 0;
+  // The length of the longest prefix of the needle that is a suffix of the
+  // input so far.
+  size_type state_ = 0;
+};
+
+using incremental_searcher = basic_incremental_searcher<char>;
+using wincremental_searcher = basic_incremental_searcher<wchar_t>;
+
+} // namespace bev
@@ -0,0 +1,261 @@
+// A read-only memory mapping of a file, viewed as a `bev::string_view`
+// without reading it into a buffer first:
+//
+//     const bev::mapped_file log{"/var/log/access.log"};
+//     log.advise(bev::mapped_file::advice::sequential);
+//     size_t lines = bev::parallel::count(log.view(), '\n');
+//
+// The operating system fills the rest of the last page of the mapping with
+// zeros. So unless the size of the file is a multiple of the page size, the
+// character after the end of the view can be dereferenced and is zero, and
+// `view()` returns a view with the safederef flag set, for which
+// `is_cstring()` is true.
+//
+// As with any mapping, the contents change if the file is modified, and
+// reading pages that were removed by truncating the file raises `SIGBUS`.
+
+#pragma once
+
+#include <bev/string_view.hpp>
+
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#  if !defined(NOMINMAX)
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace bev {
+
+  /**
+   *  @brief  A read-only memory mapping of a whole file.
+   *
+   *  Opening or mapping the file throws `std::system_error`. The views
+   *  returned by `view()` are valid until the mapping is closed.
+   */
+class mapped_file
+{
+public:
+  // Hints about the way the mapping will be accessed, see `advise()`.
+  enum class advice
+  {
+    normal,
+    sequential,
+    random,
+    // Start reading the whole file in the background.
+    willneed,
+    // Use transparent huge pages, where the file system supports them.
+    hugepage,
+  };
+
+  mapped_file() noexcept = default;
+
+  explicit
+  mapped_file(string_view path)
+  { this->open(path.c_str_or_copy().c_str()); }
+
+  mapped_file(mapped_file&& other) noexcept
+    : data_{std::exchange(other.data_, nullptr)}
+    , size_{std::exchange(other.size_, 0)}
+  { }
+
+  mapped_file&
+  operator=(mapped_file&& other) noexcept
+  {
+    if (this != &other) {
+      this->close();
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+  }
+
+  ~mapped_file()
+  { this->close(); }
+
+  // The contents of the file, with the safederef flag set if the mapping is
+  // followed by a zero byte.
+  string_view
+  view() const noexcept
+  {
+    if (!data_)
+      return string_view{""};
+    if (size_ % page_size() != 0)
+      return string_view{data_, size_, safederef};
+    return string_view{data_, size_};
+  }
+
+  const char*
+  data() const noexcept
+  { return data_; }
+
+  size_t
+  size() const noexcept
+  { return size_; }
+
+  bool
+  empty() const noexcept
+  { return size_ == 0; }
+
+  // Passes a hint about the access pattern to the operating system, and
+  // returns false if it is not supported.
+  bool
+  advise(advice hint) const noexcept;
+
+  // Unmaps the file, afterwards the object is empty.
+  void
+  close() noexcept;
+
+  static size_t
+  page_size() noexcept;
+
+private:
+  void
+  open(const char* path);
+
+  // Null for empty files, which can not be mapped.
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+#if defined(_WIN32)
+
+inline void
+mapped_file::open(const char* path)
+{
+  const HANDLE file = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    throw std::system_error(static_cast<int>(::GetLastError()),
+                            std::system_category(), "mapped_file: open");
+  LARGE_INTEGER size;
+  if (!::GetFileSizeEx(file, &size)) {
+    const DWORD error = ::GetLastError();
+    ::CloseHandle(file);
+    throw std::system_error(static_cast<int>(error), std::system_category(),
+                            "mapped_file: size");
+  }
+  if (size.QuadPart == 0) {
+    ::CloseHandle(file);
+    return;
+  }
+  const HANDLE mapping =
+      ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  const DWORD error = ::GetLastError();
+  ::CloseHandle(file);
+  if (!mapping)
+    throw std::system_error(static_cast<int>(error), std::system_category(),
+                            "mapped_file: map");
+  const void* data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  const DWORD view_error = ::GetLastError();
+  ::CloseHandle(mapping);
+  if (!data)
+    throw std::system_error(static_cast<int>(view_error),
+                            std::system_category(), "mapped_file: map");
+  data_ = static_cast<const char*>(data);
+  size_ = static_cast<size_t>(size.QuadPart);
+}
+
+inline void
+mapped_file::close() noexcept
+{
+  if (data_)
+    ::UnmapViewOfFile(data_);
+  data_ = nullptr;
+  size_ = 0;
+}
+
+inline bool
+mapped_file::advise(advice hint) const noexcept
+{
+  if (!data_)
+    return true;
+  if (hint != advice::willneed)
+    return false;
+  WIN32_MEMORY_RANGE_ENTRY range{const_cast<char*>(data_), size_};
+  return ::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0);
+}
+
+inline size_t
+mapped_file::page_size() noexcept
+{
+  SYSTEM_INFO info;
+  ::GetSystemInfo(&info);
+  return info.dwPageSize;
+}
+
+#else
+
+inline void
+mapped_file::open(const char* path)
+{
+  const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    throw std::system_error(errno, std::generic_category(), "mapped_file: open");
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    const int error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(), "mapped_file: stat");
+  }
+  if (st.st_size == 0) {
+    ::close(fd);
+    return;
+  }
+  void* data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                      MAP_SHARED, fd, 0);
+  const int error = errno;
+  ::close(fd);
+  if (data == MAP_FAILED)
+    throw std::system_error(error, std::generic_category(), "mapped_file: mmap");
+  data_ = static_cast<const char*>(data);
+  size_ = static_cast<size_t>(st.st_size);
+}
+
+inline void
+mapped_file::close() noexcept
+{
+  if (data_)
+    ::munmap(const_cast<char*>(data_), size_);
+  data_ = nullptr;
+  size_ = 0;
+}
+
+inline bool
+mapped_file::advise(advice hint) const noexcept
+{
+  if (!data_)
+    return true;
+  int flag;
+  switch (hint) {
+  case advice::normal: flag = MADV_NORMAL; break;
+  case advice::sequential: flag = MADV_SEQUENTIAL; break;
+  case advice::random: flag = MADV_RANDOM; break;
+  case advice::willneed: flag = MADV_WILLNEED; break;
+#if defined(MADV_HUGEPAGE)
+  case advice::hugepage: flag = MADV_HUGEPAGE; break;
+#endif
+  default: return false;
+  }
+  return ::madvise(const_cast<char*>(data_), size_, flag) == 0;
+}
+
+inline size_t
+mapped_file::page_size() noexcept
+{
+  static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+#endif
+
+} // namespace bev
@@ -0,0 +1,335 @@
+// A searcher for many literal patterns at once, which finds all of them in a
+// single pass over the haystack instead of calling `find()` for each one:
+//
+//     const bev::multi_searcher attacks{{"<script", "UNION SELECT", "../"}};
+//     attacks.find_all(request, [&](bev::multi_searcher::match m) {
+//       reject(m.pattern, m.offset);
+//     });
+//
+// Small sets of patterns use the Teddy prefilter from Hyperscan: the patterns
+// are distributed into 8 buckets, and a vectorized nibble lookup on the first
+// 1 to 3 bytes of every position yields the buckets that may have a match
+// there, which are then verified one pattern at a time. Larger sets use an
+// Aho-Corasick automaton with a transition table that is stored as a flat
+// array, over classes of equivalent bytes to keep its rows short.
+
+#pragma once
+
+#include <bev/string_view.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+
+namespace bev {
+
+// Sets of at most this many patterns are searched for with Teddy, larger ones
+// with Aho-Corasick, where the buckets of Teddy would be too crowded.
+inline constexpr size_t teddy_max_patterns = 32;
+
+  /**
+   *  @brief  A precomputed set of byte patterns.
+   *
+   *  Patterns are identified by their index in the list passed to the
+   *  constructor. The patterns are not copied and have to outlive the
+   *  searcher.
+   */
+class multi_searcher
+{
+public:
+  using view_type   = basic_string_view<char>;
+  using size_type   = size_t;
+
+  static constexpr size_type npos = size_type(-1);
+
+  // An occurrence of the pattern with index `pattern`, starting at `offset`.
+  struct match
+  {
+    size_type pattern;
+    size_type offset;
+  };
+
+  enum class algorithm
+  {
+    teddy,
+    aho_corasick,
+  };
+
+  // Throws `std::invalid_argument` if one of the patterns is empty, and
+  // `std::length_error` if the automaton for them would be too large.
+  explicit
+  multi_searcher(std::initializer_list<view_type> patterns)
+    : patterns_{patterns}
+  { this->build(); }
+
+  template<typename Container>
+  explicit
+  multi_searcher(const Container& patterns)
+    : patterns_(std::begin(patterns), std::end(patterns))
+  { this->build(); }
+
+  size_type
+  pattern_count() const noexcept
+  { return patterns_.size(); }
+
+  view_type
+  pattern(size_type i) const noexcept
+  { return patterns_[i]; }
+
+  algorithm
+  selected_algorithm() const noexcept
+  { return algorithm_; }
+
+  // Returns the leftmost match that starts at or after `pos`, with the
+  // lowest pattern index if several patterns start there, or
+  // `{npos, npos}`.
+  match
+  find(view_type hay, size_type pos = 0) const noexcept
+  {
+    if (pos > hay.size())
+      return {npos, npos};
+    match best{npos, npos};
+    if (algorithm_ == algorithm::teddy) {
+      // The first candidate position with a match is the leftmost one.
+      this->teddy(hay, pos, [&best](match m) {
+        if (m.pattern < best.pattern)
+          best = m;
+        return m.offset + 1;
+      });
+    } else {
+      // Matches that end later can still start further left, but not by
+      // more than the length of the longest pattern.
+      this->aho_corasick(hay, pos, [this, &best](match m) {
+        if (m.offset < best.offset
+            || (m.offset == best.offset && m.pattern < best.pattern))
+          best = m;
+        return best.offset + max_length_;
+      });
+    }
+    return best;
+  }
+
+  // Calls `on_match` with every occurrence of every pattern that starts at
+  // or after `pos`, including overlapping ones, in an unspecified order.
+  template<typename Callback>
+  void
+  find_all(view_type hay, Callback on_match, size_type pos = 0) const
+  {
+    if (pos > hay.size())
+      return;
+    const auto report = [&on_match](match m) {
+      on_match(m);
+      return npos;
+    };
+    if (algorithm_ == algorithm::teddy)
+      this->teddy(hay, pos, report);
+    else
+      this->aho_corasick(hay, pos, report);
+  }
+
+  // Whether any of the patterns occurs in `hay`.
+  bool
+  contains_any(view_type hay) const noexcept
+  { return this->find(hay).offset != npos; }
+
+private:
+  using state_type = uint32_t;
+
+  static constexpr state_type match_flag = state_type(1) << 31;
+
+  void
+  build()
+  {
+    for (view_type p : patterns_) {
+      if (p.empty())
+        throw std::invalid_argument("multi_searcher: empty pattern");
+      min_length_ = std::min(min_length_, p.size());
+      max_length_ = std::max(max_length_, p.size());
+    }
+    if (patterns_.size() <= teddy_max_patterns) {
+      algorithm_ = algorithm::teddy;
+      this->build_teddy();
+    } else {
+      algorithm_ = algorithm::aho_corasick;
+      this->build_aho_corasick();
+    }
+  }
+
+  // Sorts the patterns by their first bytes and splits them into 8 buckets
+  // of consecutive patterns, so that patterns with common prefixes share a
+  // bucket and produce fewer false candidates.
+  void
+  build_teddy()
+  {
+    masks_.width = std::min<size_type>(min_length_, 3);
+    std::vector<size_type> order(patterns_.size());
+    for (size_type i = 0; i < order.size(); ++i)
+      order[i] = i;
+    std::sort(order.begin(), order.end(), [this](size_type a, size_type b) {
+      return patterns_[a].substr(0, masks_.width)
+          < patterns_[b].substr(0, masks_.width);
+    });
+    for (size_type k = 0; k < order.size(); ++k) {
+      const size_type b = k * 8 / order.size();
+      const view_type p = patterns_[order[k]];
+      buckets_[b].push_back(order[k]);
+      for (size_type j = 0; j < masks_.width; ++j)
+        masks_.add(j, p[j], static_cast<int>(b));
+    }
+  }
+
+  // The search loops call `on_match` for every match, which returns the
+  // offset up to which the haystack still needs to be searched.
+
+  // Reports the matches in increasing order of their offsets.
+  template<typename OnMatch>
+  void
+  teddy(view_type hay, size_type pos, OnMatch on_match) const
+  {
+    const char* const p = hay.data();
+    const size_type n = hay.size();
+    size_type limit = n;
+    while (pos < limit) {
+      const size_type i = detail::teddy_kernel(p + pos, n - pos, masks_);
+      if (i == detail::kernel_npos || i >= limit - pos)
+        return;
+      pos += i;
+      const uint8_t buckets = masks_.buckets(p + pos);
+      for (size_type b = 0; b < 8; ++b) {
+        if (!((buckets >> b) & 1))
+          continue;
+        for (size_type id : buckets_[b]) {
+          const view_type pattern = patterns_[id];
+          if (pattern.size() <= n - pos
+              && detail::equal_kernel(p + pos, pattern.data(), pattern.size()))
+            limit = std::min(limit, on_match(match{id, pos}));
+        }
+      }
+      ++pos;
+    }
+  }
+
+  // Builds the trie of the patterns and turns it into a deterministic
+  // automaton, in breadth-first order so that the transitions of the
+  // failure state of every state are complete when they are needed.
+  void
+  build_aho_corasick()
+  {
+    for (view_type p : patterns_)
+      for (char c : p)
+        classes_[static_cast<unsigned char>(c)] = 1;
+    // Class 0 holds all bytes that occur in no pattern, unless there are
+    // none of them.
+    class_count_ = 1;
+    for (uint8_t& c : classes_)
+      c = c ? static_cast<uint8_t>(class_count_++) : 0;
+    if (class_count_ > 256) {
+      class_count_ = 256;
+      for (size_type b = 0; b < 256; ++b)
+        classes_[b] = static_cast<uint8_t>(b);
+    }
+
+    std::vector<std::vector<size_type>> outputs(1);
+    next_.assign(class_count_, 0);
+    for (size_type id = 0; id < patterns_.size(); ++id) {
+      state_type s = 0;
+      for (char c : patterns_[id]) {
+        state_type& t = next_[s * class_count_ + this->class_of(c)];
+        if (t == 0) {
+          t = static_cast<state_type>(outputs.size());
+          outputs.emplace_back();
+          next_.resize(next_.size() + class_count_, 0);
+        }
+        s = next_[s * class_count_ + this->class_of(c)];
+      }
+      outputs[s].push_back(id);
+    }
+
+    const size_type states = outputs.size();
+    std::vector<state_type> fail(states, 0);
+    dict_.assign(states, 0);
+    std::vector<state_type> queue{0};
+    for (size_type q = 0; q < queue.size(); ++q) {
+      const state_type s = queue[q];
+      for (size_type c = 0; c < class_count_; ++c) {
+        state_type& t = next_[s * class_count_ + c];
+        const state_type via_fail = s == 0 ? 0 : next_[fail[s] * class_count_ + c];
+        if (t == 0) {
+          t = via_fail;
+          continue;
+        }
+        fail[t] = via_fail;
+        dict_[t] = outputs[via_fail].empty() ? dict_[via_fail] : via_fail;
+        queue.push_back(t);
+      }
+    }
+
+    output_begin_.resize(states + 1);
+    for (size_type s = 0; s < states; ++s) {
+      output_begin_[s] = static_cast<state_type>(output_ids_.size());
+      output_ids_.insert(output_ids_.end(), outputs[s].begin(), outputs[s].end());
+    }
+    output_begin_[states] = static_cast<state_type>(output_ids_.size());
+
+    // Store the offsets of the rows instead of the states, to save the
+    // multiplication per byte, and flag the states that end a pattern.
+    if (states * class_count_ >= match_flag)
+      throw std::length_error("multi_searcher: too many patterns");
+    for (state_type& t : next_) {
+      const bool ends = output_begin_[t] != output_begin_[t + 1] || dict_[t];
+      t = static_cast<state_type>(t * class_count_) | (ends ? match_flag : 0);
+    }
+  }
+
+  size_type
+  class_of(char c) const noexcept
+  { return classes_[static_cast<unsigned char>(c)]; }
+
+  // Reports the matches in increasing order of their end positions.
+  template<typename OnMatch>
+  void
+  aho_corasick(view_type hay, size_type pos, OnMatch on_match) const
+  {
+    size_type limit = hay.size();
+    state_type row = 0;
+    for (size_type i = pos; i < limit; ++i) {
+      row = next_[(row & ~match_flag) + this->class_of(hay[i])];
+      if (!(row & match_flag))
+        continue;
+      const state_type s =
+          static_cast<state_type>((row & ~match_flag) / class_count_);
+      state_type t = output_begin_[s] != output_begin_[s + 1] ? s : dict_[s];
+      for (; t != 0; t = dict_[t])
+        for (state_type k = output_begin_[t]; k != output_begin_[t + 1]; ++k) {
+          const size_type id = output_ids_[k];
+          limit = std::min(
+              limit, on_match(match{id, i + 1 - patterns_[id].size()}));
+        }
+    }
+  }
+
+  std::vector<view_type> patterns_;
+  algorithm algorithm_ = algorithm::teddy;
+  size_type min_length_ = npos;
+  size_type max_length_ = 0;
+
+  // Teddy
+  detail::teddy_masks masks_;
+  std::vector<size_type> buckets_[8];
+
+  // Aho-Corasick: `next_` holds a row of `class_count_` transitions for
+  // each state, each of them the offset of the row of the next state and
+  // `match_flag` if it ends a pattern. `dict_` links to the next state on
+  // the failure chain that ends a pattern, and the patterns ending at state
+  // `s` itself are `output_ids_[output_begin_[s] .. output_begin_[s + 1]]`.
+  uint8_t classes_[256] = {};
+  size_type class_count_ = 0;
+  std::vector<state_type> next_;
+  std::vector<state_type> dict_;
+  std::vector<state_type> output_begin_;
+  std::vector<size_type> output_ids_;
+};
+
+} // namespace bev
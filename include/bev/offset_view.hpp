@@ -0,0 +1,277 @@
+// A view of 8 instead of 16 bytes for indexes of many strings in one arena,
+// which stores a 32-bit offset from the start of the arena instead of a
+// pointer:
+//
+//     const bev::offset_base base{arena};              // e.g. a mapped file
+//     std::vector<bev::offset_view> index;
+//     for (bev::string_view term : bev::split(arena, '\n'))
+//       index.push_back(base.make(term));
+//     std::sort(index.begin(), index.end(), base.less());
+//
+//     bev::string_view term = base.view(index[i]);
+//
+// A `bev::basic_offset_view` holds an offset of up to 32 bits and a length of
+// up to 31 bits, with the safederef flag in the highest bit of the length,
+// and needs the start of the arena to be resolved into a
+// `bev::basic_string_view`. `bev::basic_offset_base` holds that pointer, and
+// provides the comparisons, searches and hashes of resolved views, as well
+// as function objects for sorting offset views and for unordered
+// containers of them.
+
+#pragma once
+
+#include <bev/string_view.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+
+namespace bev {
+
+  /**
+   *  @brief  A non-owning reference to a string in an arena, relative to
+   *          the start of the arena.
+   *
+   *  @tparam CharT   Type of character
+   *  @tparam Traits  Traits for character type
+   *
+   *  The offset and the length count characters. Offset views can only be
+   *  compared once they are resolved against their arena.
+   */
+template<typename CharT, typename Traits = std::char_traits<CharT>>
+class basic_offset_view
+{
+  static constexpr uint32_t safederef_flag_mask = uint32_t(1) << 31;
+
+public:
+  using view_type = basic_string_view<CharT, Traits>;
+  using size_type = size_t;
+
+  static constexpr size_type max_offset = UINT32_MAX;
+  static constexpr size_type max_length = safederef_flag_mask - 1;
+
+  constexpr
+  basic_offset_view() noexcept = default;
+
+  // The view `sv` into the arena starting at `base`, with the safederef
+  // flag preserved. Throws `std::length_error` if `sv` doesn't start within
+  // `max_offset` characters after `base` or is longer than `max_length`.
+  basic_offset_view(const CharT* base, view_type sv)
+  {
+    const uintptr_t distance = reinterpret_cast<uintptr_t>(sv.data())
+                             - reinterpret_cast<uintptr_t>(base);
+    if (sv.empty() && !sv.data())
+      return;
+    if (distance / sizeof(CharT) > max_offset || sv.size() > max_length)
+      throw std::length_error("basic_offset_view: view doesn't fit");
+    offset_ = static_cast<uint32_t>(distance / sizeof(CharT));
+    len_ = static_cast<uint32_t>(sv.size())
+         | (view_type::test_safederef_bit(sv.len_) ? safederef_flag_mask : 0);
+  }
+
+  // The `length <= max_length` characters at `offset`, without the
+  // safederef flag.
+  constexpr
+  basic_offset_view(uint32_t offset, uint32_t length) noexcept
+    : offset_{offset}, len_{length}
+  { }
+
+  // Resolves the offset view against the arena starting at `base`.
+  constexpr view_type
+  view(const CharT* base) const noexcept
+  {
+    if (len_ & safederef_flag_mask)
+      return view_type{base + offset_, this->size(), safederef};
+    return view_type{base + offset_, this->size()};
+  }
+
+  constexpr size_type
+  offset() const noexcept
+  { return offset_; }
+
+  constexpr size_type
+  size() const noexcept
+  { return len_ & ~safederef_flag_mask; }
+
+  constexpr size_type
+  length() const noexcept
+  { return this->size(); }
+
+  [[nodiscard]] constexpr bool
+  empty() const noexcept
+  { return this->size() == 0; }
+
+  constexpr void
+  remove_prefix(size_type n) noexcept
+  {
+    offset_ += static_cast<uint32_t>(n);
+    len_ -= static_cast<uint32_t>(n);
+  }
+
+  // Like `basic_string_view::remove_suffix()`, sets the safederef flag if
+  // `n` is not zero.
+  constexpr void
+  remove_suffix(size_type n) noexcept
+  {
+    len_ = static_cast<uint32_t>(len_ - n) | (n ? safederef_flag_mask : 0);
+  }
+
+  // Like `basic_string_view::substr()`, for `pos <= size()`.
+  constexpr basic_offset_view
+  substr(size_type pos = 0, size_type n = view_type::npos) const noexcept
+  {
+    basic_offset_view result = *this;
+    result.remove_prefix(pos);
+    if (n < result.size())
+      result.remove_suffix(result.size() - n);
+    return result;
+  }
+
+  // Whether both refer to the same characters of the arena.
+  constexpr bool
+  same_range(basic_offset_view other) const noexcept
+  { return offset_ == other.offset_ && this->size() == other.size(); }
+
+private:
+  uint32_t offset_ = 0;
+  uint32_t len_ = 0;
+};
+
+  /**
+   *  @brief  The start of an arena, for creating and resolving offset views.
+   *
+   *  @tparam CharT   Type of character
+   *  @tparam Traits  Traits for character type
+   *
+   *  All operations resolve their offset views first, so they have the
+   *  same results as the corresponding ones of `basic_string_view`.
+   */
+template<typename CharT, typename Traits = std::char_traits<CharT>>
+class basic_offset_base
+{
+public:
+  using view_type   = basic_string_view<CharT, Traits>;
+  using offset_type = basic_offset_view<CharT, Traits>;
+  using size_type   = size_t;
+
+  constexpr explicit
+  basic_offset_base(const CharT* base) noexcept
+    : base_{base}
+  { }
+
+  constexpr explicit
+  basic_offset_base(view_type arena) noexcept
+    : base_{arena.data()}
+  { }
+
+  constexpr const CharT*
+  data() const noexcept
+  { return base_; }
+
+  // Throws `std::length_error` if `sv` doesn't fit into an offset view.
+  offset_type
+  make(view_type sv) const
+  { return offset_type{base_, sv}; }
+
+  constexpr view_type
+  view(offset_type v) const noexcept
+  { return v.view(base_); }
+
+  constexpr view_type
+  operator()(offset_type v) const noexcept
+  { return v.view(base_); }
+
+  constexpr int
+  compare(offset_type x, offset_type y) const noexcept
+  { return this->view(x).compare(this->view(y)); }
+
+  constexpr int
+  compare(offset_type x, view_type y) const noexcept
+  { return this->view(x).compare(y); }
+
+  // Views of the same range are equal without looking at the characters.
+  constexpr bool
+  equal(offset_type x, offset_type y) const noexcept
+  { return x.same_range(y) || this->view(x) == this->view(y); }
+
+  constexpr bool
+  equal(offset_type x, view_type y) const noexcept
+  { return this->view(x) == y; }
+
+  constexpr size_type
+  find(offset_type v, view_type needle, size_type pos = 0) const noexcept
+  { return this->view(v).find(needle, pos); }
+
+  constexpr size_type
+  find(offset_type v, CharT c, size_type pos = 0) const noexcept
+  { return this->view(v).find(c, pos); }
+
+  constexpr size_t
+  hash(offset_type v) const noexcept
+  { return bev::hash<>{}(this->view(v)); }
+
+  // Function objects for `std::sort()`, `std::lower_bound()` and ordered
+  // containers of offset views. Also compare offset views with views.
+  struct key_less
+  {
+    const CharT* base;
+
+    constexpr bool
+    operator()(offset_type x, offset_type y) const noexcept
+    { return x.view(base) < y.view(base); }
+
+    constexpr bool
+    operator()(offset_type x, view_type y) const noexcept
+    { return x.view(base) < y; }
+
+    constexpr bool
+    operator()(view_type x, offset_type y) const noexcept
+    { return x < y.view(base); }
+  };
+
+  // Function objects for unordered containers of offset views.
+  struct key_hash
+  {
+    const CharT* base;
+
+    constexpr size_t
+    operator()(offset_type v) const noexcept
+    { return bev::hash<>{}(v.view(base)); }
+  };
+
+  struct key_equal
+  {
+    const CharT* base;
+
+    constexpr bool
+    operator()(offset_type x, offset_type y) const noexcept
+    { return x.same_range(y) || x.view(base) == y.view(base); }
+  };
+
+  constexpr key_less
+  less() const noexcept
+  { return key_less{base_}; }
+
+  constexpr key_hash
+  hasher() const noexcept
+  { return key_hash{base_}; }
+
+  constexpr key_equal
+  equal_to() const noexcept
+  { return key_equal{base_}; }
+
+private:
+  const CharT* base_;
+};
+
+// basic_offset_view typedef names
+using offset_view = basic_offset_view<char>;
+using woffset_view = basic_offset_view<wchar_t>;
+using u16offset_view = basic_offset_view<char16_t>;
+using u32offset_view = basic_offset_view<char32_t>;
+
+using offset_base = basic_offset_base<char>;
+using woffset_base = basic_offset_base<wchar_t>;
+using u16offset_base = basic_offset_base<char16_t>;
+using u32offset_base = basic_offset_base<char32_t>;
+
+} // namespace bev
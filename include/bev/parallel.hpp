@@ -0,0 +1,249 @@
+// Parallel versions of searches over very large views, e.g. of memory-mapped
+// log files:
+//
+//     bev::parallel::thread_executor pool;
+//     size_t lines = bev::parallel::count(log, '\n', pool);
+//     size_t error = bev::parallel::find(log, "status=500"_sv, pool);
+//
+// The view is partitioned into chunks of `chunk_size` characters, or of
+// `default_chunk_size` if it is 0, which the executor hands out to its
+// threads in increasing order. Searches for a needle extend every chunk by
+// `needle.size() - 1` characters, to find the matches that cross the end of
+// the chunk, and the results don't depend on the scheduling: `find()` returns
+// the same position as `basic_string_view::find()`, and `split_positions()`
+// returns the positions in increasing order.
+//
+// An executor is any object with a member function `bulk(n, f)` that calls
+// `f(i)` once for every `i` in `[0, n)`, possibly concurrently, and returns
+// when all of the calls have finished. For example, for the standard parallel
+// algorithms:
+//
+//     struct par_executor {
+//       template<typename F>
+//       void bulk(size_t n, F f) const {
+//         std::vector<size_t> chunks(n);
+//         std::iota(chunks.begin(), chunks.end(), size_t(0));
+//         std::for_each(std::execution::par, chunks.begin(), chunks.end(), f);
+//       }
+//     };
+
+#pragma once
+
+#include <bev/string_view.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace bev {
+namespace parallel {
+
+// The number of characters per chunk, large enough to amortize the scheduling
+// and small enough to fit into the L2 cache of most CPUs.
+inline constexpr size_t default_chunk_size = size_t(1) << 20;
+
+  /**
+   *  @brief  An executor that runs the chunks on `std::thread`s.
+   *
+   *  Every call of `bulk()` starts its threads, which take the next chunk
+   *  from a shared counter whenever they are done with the previous one, so
+   *  that threads that are slowed down don't delay the others. The calling
+   *  thread works on the chunks as well. If `f` throws, the remaining chunks
+   *  are skipped, and the first exception is rethrown by `bulk()`.
+   */
+class thread_executor
+{
+public:
+  explicit
+  thread_executor(unsigned threads = std::thread::hardware_concurrency()) noexcept
+    : threads_{threads ? threads : 1}
+  { }
+
+  unsigned
+  concurrency() const noexcept
+  { return threads_; }
+
+  template<typename F>
+  void
+  bulk(size_t n, F f) const
+  {
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    const auto work = [&] {
+      try {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < n;)
+          f(i);
+      } catch (...) {
+        next.store(n, std::memory_order_relaxed);
+        const std::lock_guard<std::mutex> lock{error_mutex};
+        if (!error)
+          error = std::current_exception();
+      }
+    };
+    std::vector<std::thread> threads;
+    const size_t helpers = std::min<size_t>(threads_, n);
+    for (size_t t = 1; t < helpers; ++t) {
+      try {
+        threads.emplace_back(work);
+      } catch (const std::system_error&) {
+        // Continue with the threads that could be started.
+        break;
+      }
+    }
+    work();
+    for (std::thread& thread : threads)
+      thread.join();
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+private:
+  unsigned threads_;
+};
+
+namespace detail {
+
+inline void
+atomic_min(std::atomic<size_t>& x, size_t value) noexcept
+{
+  size_t current = x.load(std::memory_order_relaxed);
+  while (value < current
+         && !x.compare_exchange_weak(current, value, std::memory_order_relaxed))
+  { }
+}
+
+// A `chunk_size` of 0 selects the default.
+constexpr size_t
+chunk_size_or_default(size_t chunk_size) noexcept
+{ return chunk_size ? chunk_size : default_chunk_size; }
+
+inline size_t
+chunk_count(size_t n, size_t chunk_size) noexcept
+{ return n / chunk_size + (n % chunk_size != 0); }
+
+} // namespace detail
+
+// Returns the position of the first occurrence of `needle` in `hay`, or
+// `npos`. Chunks that start after a match that was already found are
+// skipped.
+template<typename CharT, typename Traits,
+         typename Executor = thread_executor>
+size_t
+find(basic_string_view<CharT, Traits> hay,
+     basic_string_view<CharT, Traits> needle,
+     const Executor& executor = Executor{},
+     size_t chunk_size = default_chunk_size)
+{
+  chunk_size = detail::chunk_size_or_default(chunk_size);
+  using view_type = basic_string_view<CharT, Traits>;
+  const size_t n = hay.size();
+  const size_t m = needle.size();
+  if (m > n)
+    return view_type::npos;
+  if (m == 0)
+    return 0;
+
+  // The chunks partition the positions at which a match can start.
+  const size_t starts = n - m + 1;
+  std::atomic<size_t> best{view_type::npos};
+  executor.bulk(detail::chunk_count(starts, chunk_size), [&](size_t i) {
+    const size_t begin = i * chunk_size;
+    if (begin >= best.load(std::memory_order_relaxed))
+      return;
+    const size_t len = std::min(chunk_size, starts - begin) + m - 1;
+    const size_t pos = hay.substr(begin, len).find(needle);
+    if (pos != view_type::npos)
+      detail::atomic_min(best, begin + pos);
+  });
+  return best.load();
+}
+
+template<typename Executor = thread_executor>
+size_t
+find(basic_string_view<char> hay, basic_string_view<char> needle,
+     const Executor& executor = Executor{},
+     size_t chunk_size = default_chunk_size)
+{
+  return parallel::find<char, std::char_traits<char>>(
+      hay, needle, executor, chunk_size);
+}
+
+// Returns the number of occurrences of `c` in `str`.
+template<typename CharT, typename Traits,
+         typename Executor = thread_executor>
+size_t
+count(basic_string_view<CharT, Traits> str, CharT c,
+      const Executor& executor = Executor{},
+      size_t chunk_size = default_chunk_size)
+{
+  chunk_size = detail::chunk_size_or_default(chunk_size);
+  std::atomic<size_t> total{0};
+  executor.bulk(detail::chunk_count(str.size(), chunk_size), [&](size_t i) {
+    const basic_string_view<CharT, Traits> chunk =
+        str.substr(i * chunk_size, chunk_size);
+    size_t result = 0;
+    for (CharT x : chunk)
+      result += Traits::eq(x, c);
+    total.fetch_add(result, std::memory_order_relaxed);
+  });
+  return total.load();
+}
+
+template<typename Executor = thread_executor>
+size_t
+count(basic_string_view<char> str, char c,
+      const Executor& executor = Executor{},
+      size_t chunk_size = default_chunk_size)
+{
+  return parallel::count<char, std::char_traits<char>>(
+      str, c, executor, chunk_size);
+}
+
+// Returns the positions of all occurrences of `c` in `str`, in increasing
+// order, e.g. the ends of the lines for `'\n'`.
+template<typename CharT, typename Traits,
+         typename Executor = thread_executor>
+std::vector<size_t>
+split_positions(basic_string_view<CharT, Traits> str, CharT c,
+                const Executor& executor = Executor{},
+                size_t chunk_size = default_chunk_size)
+{
+  chunk_size = detail::chunk_size_or_default(chunk_size);
+  using view_type = basic_string_view<CharT, Traits>;
+  std::vector<std::vector<size_t>> chunks(
+      detail::chunk_count(str.size(), chunk_size));
+  executor.bulk(chunks.size(), [&](size_t i) {
+    const size_t begin = i * chunk_size;
+    const view_type chunk = str.substr(begin, chunk_size);
+    for (size_t pos = chunk.find(c); pos != view_type::npos;
+         pos = chunk.find(c, pos + 1))
+      chunks[i].push_back(begin + pos);
+  });
+
+  size_t total = 0;
+  for (const std::vector<size_t>& positions : chunks)
+    total += positions.size();
+  std::vector<size_t> result;
+  result.reserve(total);
+  for (const std::vector<size_t>& positions : chunks)
+    result.insert(result.end(), positions.begin(), positions.end());
+  return result;
+}
+
+template<typename Executor = thread_executor>
+std::vector<size_t>
+split_positions(basic_string_view<char> str, char c,
+                const Executor& executor = Executor{},
+                size_t chunk_size = default_chunk_size)
+{
+  return parallel::split_positions<char, std::char_traits<char>>(
+      str, c, executor, chunk_size);
+}
+
+} // namespace parallel
+} // namespace bev
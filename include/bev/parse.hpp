@@ -0,0 +1,335 @@
+// Parsing of decimal numbers from views, without copying them into a
+// `std::string` for `strtol()` or `strtod()`:
+//
+//     auto port = bev::parse<uint16_t>(value);
+//     if (!port)
+//       return error(port.ec);
+//
+//     // "12.5 ms" -> 12.5, leaving " ms" in `rest`.
+//     bev::string_view rest = field;
+//     double latency = bev::consume_number<double>(rest).value;
+//
+// The accepted syntax is that of `std::from_chars()`: an optional minus sign
+// (only for signed and floating-point types), decimal digits, and for
+// `double` an optional fraction and exponent, or `inf`, `infinity` and
+// `nan`. Leading whitespace and plus signs are not accepted.
+//
+// Integers are parsed 8 digits at a time with SWAR arithmetic on 64-bit
+// words. Doubles with at most 19 significant digits whose mantissa and
+// power of ten are both exactly representable (the Clinger fast path, which
+// covers most numbers in text formats) are computed with a single
+// multiplication or division, which is correctly rounded. All others are
+// passed on to `strtod()`, which receives the data of the view itself if it
+// is null-terminated right after the number, and a copy otherwise. Define
+// `BEV_STRING_VIEW_STRTOD` to always use `strtod()`. Like `from_chars()`,
+// the fast path ignores the locale, while `strtod()` relies on the "C"
+// locale for the decimal point. Copies of numbers longer than 63 characters
+// are allocated on the heap, so parsing a `double` can throw
+// `std::bad_alloc`; parsing integers never throws.
+
+#pragma once
+
+#include <bev/string_view.hpp>
+
+#include <cerrno>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <system_error>
+#include <type_traits>
+
+namespace bev {
+
+  /**
+   *  @brief  The result of `bev::parse()` and `bev::consume_number()`.
+   *
+   *  `ec` is `std::errc::invalid_argument` if there is no number, and
+   *  `std::errc::result_out_of_range` if it doesn't fit into `T`, in which
+   *  case `value` is zero.
+   */
+template<typename T>
+struct parse_result
+{
+  T value = T{};
+  std::errc ec = std::errc{};
+
+  constexpr explicit
+  operator bool() const noexcept
+  { return ec == std::errc{}; }
+};
+
+namespace detail {
+
+template<typename T>
+inline constexpr bool is_parsable_v =
+    (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+    || std::is_same_v<T, double>;
+
+constexpr bool
+is_digit_(char c) noexcept
+{ return static_cast<unsigned char>(c - '0') < 10; }
+
+// Whether all bytes of the little-endian word `v` are ASCII digits.
+constexpr bool
+is_eight_digits_(uint64_t v) noexcept
+{
+  return ((v & 0xF0F0F0F0F0F0F0F0)
+          | (((v + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4))
+      == 0x3333333333333333;
+}
+
+// The value of the 8 digits in `v`, combining pairs of adjacent digits,
+// then pairs of pairs, and then the two halves.
+constexpr uint32_t
+parse_eight_digits_(uint64_t v) noexcept
+{
+  const uint64_t mask = 0x000000FF000000FF;
+  const uint64_t mul1 = 100 + (uint64_t(1000000) << 32);
+  const uint64_t mul2 = 1 + (uint64_t(10000) << 32);
+  v -= 0x3030303030303030;
+  v = v * 10 + (v >> 8);
+  v = ((v & mask) * mul1 + ((v >> 16) & mask) * mul2) >> 32;
+  return static_cast<uint32_t>(v);
+}
+
+// Parses the digits at `p[i..n)` into `acc`, and returns the position after
+// them. Sets `overflow` if the value does not fit into 64 bits.
+constexpr size_t
+parse_digits_(const char* p, size_t n, size_t i, uint64_t& acc,
+              bool& overflow) noexcept
+{
+  // At most 16 digits this way, which always fit.
+  for (int chunk = 0; chunk < 2 && n - i >= 8; ++chunk) {
+    const uint64_t v = load_le_<uint64_t>(p + i);
+    if (!is_eight_digits_(v))
+      break;
+    acc = acc * 100000000 + parse_eight_digits_(v);
+    i += 8;
+  }
+  constexpr uint64_t max_tenth = std::numeric_limits<uint64_t>::max() / 10;
+  for (; i < n && is_digit_(p[i]); ++i) {
+    const unsigned d = static_cast<unsigned>(p[i] - '0');
+    if (acc > max_tenth || (acc == max_tenth && d > 5))
+      overflow = true;
+    else
+      acc = acc * 10 + d;
+  }
+  return i;
+}
+
+template<typename T>
+constexpr parse_result<T>
+parse_integer_(const char* p, size_t n, size_t& len) noexcept
+{
+  using unsigned_type = std::make_unsigned_t<T>;
+  bool negative = false;
+  size_t i = 0;
+  if constexpr (std::is_signed_v<T>) {
+    if (n != 0 && p[0] == '-') {
+      negative = true;
+      i = 1;
+    }
+  }
+  uint64_t acc = 0;
+  bool overflow = false;
+  len = parse_digits_(p, n, i, acc, overflow);
+  if (len == i) {
+    len = 0;
+    return {T{}, std::errc::invalid_argument};
+  }
+  const uint64_t limit = static_cast<uint64_t>(std::numeric_limits<T>::max())
+                       + (negative ? 1 : 0);
+  if (overflow || acc > limit)
+    return {T{}, std::errc::result_out_of_range};
+  if (negative)
+    return {static_cast<T>(unsigned_type(0) - static_cast<unsigned_type>(acc)),
+            std::errc{}};
+  return {static_cast<T>(acc), std::errc{}};
+}
+
+constexpr bool
+starts_with_ci_(const char* p, size_t n, const char* word, size_t m) noexcept
+{
+  if (n < m)
+    return false;
+  for (size_t i = 0; i < m; ++i)
+    if ((p[i] | 0x20) != word[i])
+      return false;
+  return true;
+}
+
+// Powers of ten that are exactly representable as doubles.
+inline constexpr double exact_powers_of_ten_[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// `str` is the whole input, so that `strtod()` can use its data directly if
+// the number extends to its end. Throws `std::bad_alloc` if a long number
+// can't be copied.
+inline parse_result<double>
+parse_double_(basic_string_view<char> str, size_t& len)
+{
+  const char* const p = str.data();
+  const size_t n = str.size();
+  const bool negative = n != 0 && p[0] == '-';
+  size_t i = negative;
+
+  // Special values, `nan` optionally followed by `(chars)`.
+  if (starts_with_ci_(p + i, n - i, "inf", 3)) {
+    len = i + (starts_with_ci_(p + i, n - i, "infinity", 8) ? 8 : 3);
+    const double inf = std::numeric_limits<double>::infinity();
+    return {negative ? -inf : inf, std::errc{}};
+  }
+  if (starts_with_ci_(p + i, n - i, "nan", 3)) {
+    len = i + 3;
+    if (len < n && p[len] == '(') {
+      size_t j = len + 1;
+      while (j < n && (is_digit_(p[j]) || p[j] == '_'
+                       || static_cast<unsigned char>((p[j] | 0x20) - 'a') < 26))
+        ++j;
+      if (j < n && p[j] == ')')
+        len = j + 1;
+    }
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    return {negative ? -nan : nan, std::errc{}};
+  }
+
+  // The significant digits, up to 19 of them, and the power of ten to
+  // multiply them with. Leading zeros are not significant.
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int64_t exponent = 0;
+  bool truncated = false;
+  bool any_digits = false;
+  const auto digit = [&](char c, bool fraction) {
+    any_digits = true;
+    if (mantissa == 0 && c == '0') {
+      exponent -= fraction;
+    } else if (digits < 19) {
+      mantissa = mantissa * 10 + static_cast<unsigned>(c - '0');
+      ++digits;
+      exponent -= fraction;
+    } else {
+      truncated = true;
+      exponent += !fraction;
+    }
+  };
+  for (; i < n && is_digit_(p[i]); ++i)
+    digit(p[i], false);
+  if (i < n && p[i] == '.') {
+    ++i;
+    // Fractions often have many digits, so take 8 at a time while they
+    // are all significant.
+    while (mantissa != 0 && digits <= 11 && n - i >= 8
+           && is_eight_digits_(load_le_<uint64_t>(p + i))) {
+      mantissa = mantissa * 100000000 + parse_eight_digits_(load_le_<uint64_t>(p + i));
+      digits += 8;
+      exponent -= 8;
+      i += 8;
+    }
+    for (; i < n && is_digit_(p[i]); ++i)
+      digit(p[i], true);
+  }
+  if (!any_digits) {
+    len = 0;
+    return {0.0, std::errc::invalid_argument};
+  }
+  // The exponent only belongs to the number if it has digits.
+  if (i < n && (p[i] | 0x20) == 'e') {
+    size_t j = i + 1;
+    const bool negative_exponent = j < n && p[j] == '-';
+    if (j < n && (p[j] == '-' || p[j] == '+'))
+      ++j;
+    if (j < n && is_digit_(p[j])) {
+      int64_t e = 0;
+      for (; j < n && is_digit_(p[j]); ++j)
+        if (e < 100000)
+          e = e * 10 + (p[j] - '0');
+      exponent += negative_exponent ? -e : e;
+      i = j;
+    }
+  }
+  len = i;
+
+#if !defined(BEV_STRING_VIEW_STRTOD) \
+    && (!defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD == 0)
+  if (mantissa == 0)
+    return {negative ? -0.0 : 0.0, std::errc{}};
+  if (!truncated && mantissa <= (uint64_t(1) << 53)
+      && exponent >= -22 && exponent <= 22) {
+    double value = static_cast<double>(mantissa);
+    if (exponent < 0)
+      value /= exact_powers_of_ten_[-exponent];
+    else
+      value *= exact_powers_of_ten_[exponent];
+    return {negative ? -value : value, std::errc{}};
+  }
+#endif
+
+  const basic_cstring_arg<char, std::char_traits<char>, 64> number{str.take(len)};
+  char* end = nullptr;
+  const int saved_errno = errno;
+  errno = 0;
+  const double value = std::strtod(number.c_str(), &end);
+  const bool range_error = errno == ERANGE;
+  errno = saved_errno;
+  if (end != number.c_str() + len)
+    return {0.0, std::errc::invalid_argument};
+  // Denormal results are reported as range errors by some platforms.
+  if (range_error && (value == 0.0 || std::isinf(value)))
+    return {0.0, std::errc::result_out_of_range};
+  return {value, std::errc{}};
+}
+
+// Only the copy for `strtod()` can throw.
+template<typename T>
+inline constexpr bool is_nothrow_parsable_v = !std::is_same_v<T, double>;
+
+template<typename T>
+constexpr parse_result<T>
+parse_prefix_(basic_string_view<char> str, size_t& len)
+    noexcept(is_nothrow_parsable_v<T>)
+{
+  if constexpr (std::is_same_v<T, double>)
+    return parse_double_(str, len);
+  else
+    return parse_integer_<T>(str.data(), str.size(), len);
+}
+
+} // namespace detail
+
+// Parses all of `str` as a number of type `T`, which is an integral type or
+// `double`. Trailing characters are an error. Integers can also be parsed
+// in constant expressions.
+template<typename T>
+constexpr parse_result<T>
+parse(basic_string_view<char> str) noexcept(detail::is_nothrow_parsable_v<T>)
+{
+  static_assert(detail::is_parsable_v<T>,
+                "bev::parse supports integral types and double");
+  size_t len = 0;
+  parse_result<T> result = detail::parse_prefix_<T>(str, len);
+  if (result.ec != std::errc::invalid_argument && len != str.size())
+    return {T{}, std::errc::invalid_argument};
+  return result;
+}
+
+// Parses the longest prefix of `str` that is a number of type `T`, and
+// removes it from `str`, also if it is out of range. If there is no number,
+// `str` is not modified.
+template<typename T>
+constexpr parse_result<T>
+consume_number(basic_string_view<char>& str)
+    noexcept(detail::is_nothrow_parsable_v<T>)
+{
+  static_assert(detail::is_parsable_v<T>,
+                "bev::consume_number supports integral types and double");
+  size_t len = 0;
+  const parse_result<T> result = detail::parse_prefix_<T>(str, len);
+  str.remove_prefix(len);
+  return result;
+}
+
+} // namespace bev
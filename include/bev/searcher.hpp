@@ -0,0 +1,250 @@
+// Searchers that preprocess a needle once, for finding it in many haystacks:
+//
+//     const bev::searcher error{"connection reset by peer"};
+//     for (bev::string_view line : lines)
+//       if (line.find(error) != bev::string_view::npos)
+//         ++count;
+//
+// The searchers also implement the searcher protocol of `std::search()`, for
+// iterators into contiguous storage:
+//
+//     auto it = std::search(text.begin(), text.end(), error);
+//
+// The algorithm is chosen based on the needle. For `char` views with the
+// default traits, short needles use the vectorized first/last character
+// filter of `basic_string_view::find()`. Long needles use
+// Boyer-Moore-Horspool if its shifts are long enough to beat the filter,
+// which depends on the number of distinct characters in the needle. All
+// other character types use the Two-Way algorithm, which only needs
+// `Traits::eq()` and `Traits::lt()`, no extra memory, and is linear in the
+// worst case.
+
+#pragma once
+
+#include <bev/string_view.hpp>
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace bev {
+
+// Needles of char views with at least this many characters are searched for
+// with Boyer-Moore-Horspool instead of the vectorized filter, if the average
+// shift for the characters of the needle is at least `horspool_min_shift`.
+// Shorter shifts are slower than the filter, which scans 16 or 32 bytes per
+// step.
+inline constexpr size_t horspool_threshold = 64;
+inline constexpr size_t horspool_min_shift = 32;
+
+  /**
+   *  @brief  A needle with precomputed search tables.
+   *
+   *  @tparam CharT   Type of character
+   *  @tparam Traits  Traits for character type
+   *
+   *  The needle is not copied and has to outlive the searcher.
+   */
+template<typename CharT, typename Traits>
+class basic_searcher
+{
+public:
+  using view_type   = basic_string_view<CharT, Traits>;
+  using traits_type = Traits;
+  using size_type   = size_t;
+
+  // The algorithms a searcher can use.
+  enum class algorithm
+  {
+    // A single character, or the first/last character filter.
+    kernel,
+    horspool,
+    two_way,
+  };
+
+  explicit
+  basic_searcher(view_type needle) noexcept
+    : needle_{needle}
+  {
+    if constexpr (detail::is_default_char_v<CharT, Traits>) {
+      if (needle.size() < horspool_threshold) {
+        algorithm_ = algorithm::kernel;
+        return;
+      }
+      shift_.fill(needle.size());
+      for (size_type i = 0; i + 1 < needle.size(); ++i)
+        shift_[static_cast<unsigned char>(needle[i])] = needle.size() - 1 - i;
+      // Text that resembles the needle mostly consists of its characters.
+      bool seen[256] = {};
+      size_type total = 0, distinct = 0;
+      for (CharT c : needle)
+        if (!seen[static_cast<unsigned char>(c)]) {
+          seen[static_cast<unsigned char>(c)] = true;
+          total += shift_[static_cast<unsigned char>(c)];
+          ++distinct;
+        }
+      algorithm_ = total >= horspool_min_shift * distinct ? algorithm::horspool
+                                                          : algorithm::kernel;
+    } else {
+      if (needle.size() < 2) {
+        algorithm_ = algorithm::kernel;
+        return;
+      }
+      algorithm_ = algorithm::two_way;
+      this->critical_factorization();
+    }
+  }
+
+  view_type
+  needle() const noexcept
+  { return needle_; }
+
+  algorithm
+  selected_algorithm() const noexcept
+  { return algorithm_; }
+
+  // Returns the position of the first occurrence of the needle in `hay` at
+  // or after `pos`, or `npos`.
+  size_type
+  find_in(view_type hay, size_type pos = 0) const noexcept
+  {
+    const size_type n = hay.size();
+    const size_type m = needle_.size();
+    if (pos > n || m > n - pos)
+      return m == 0 && pos <= n ? pos : view_type::npos;
+
+    size_type ret;
+    switch (algorithm_) {
+    case algorithm::horspool:
+      ret = this->horspool(hay.data() + pos, n - pos);
+      break;
+    case algorithm::two_way:
+      ret = this->two_way(hay.data() + pos, n - pos);
+      break;
+    default:
+      return hay.find(needle_, pos);
+    }
+    return ret == view_type::npos ? ret : pos + ret;
+  }
+
+  // The searcher protocol of `std::search()`. Returns the range of the first
+  // match, or `{last, last}`. Requires `[first, last)` to be contiguous.
+  template<typename RandomIt>
+  std::pair<RandomIt, RandomIt>
+  operator()(RandomIt first, RandomIt last) const
+  {
+    const size_type n = static_cast<size_type>(last - first);
+    const size_type ret = this->find_in(view_type(n ? &*first : nullptr, n));
+    if (ret == view_type::npos)
+      return {last, last};
+    return {first + ret, first + ret + needle_.size()};
+  }
+
+private:
+  static constexpr size_type no_index = size_type(-1);
+
+  size_type
+  horspool(const CharT* hay, size_type n) const noexcept
+  {
+    const size_type m = needle_.size();
+    const CharT last = needle_[m - 1];
+    for (size_type j = 0; j + m <= n;
+         j += shift_[static_cast<unsigned char>(hay[j + m - 1])])
+      if (traits_type::eq(hay[j + m - 1], last)
+          && traits_type::compare(hay + j, needle_.data(), m - 1) == 0)
+        return j;
+    return view_type::npos;
+  }
+
+  // Computes the critical factorization `needle = u v` with `suffix_ = |u|`,
+  // and the period of `v`, from the maximal suffixes under both orderings.
+  void
+  critical_factorization() noexcept
+  {
+    const size_type m = needle_.size();
+    size_type suffix[2];
+    size_type period[2];
+    for (int reverse = 0; reverse < 2; ++reverse) {
+      size_type max_suffix = no_index;
+      size_type j = 0, k = 1, p = 1;
+      while (j + k < m) {
+        const CharT a = needle_[j + k];
+        const CharT b = needle_[max_suffix + k];
+        if (reverse ? traits_type::lt(b, a) : traits_type::lt(a, b)) {
+          j += k;
+          k = 1;
+          p = j - max_suffix;
+        } else if (traits_type::eq(a, b)) {
+          if (k != p) {
+            ++k;
+          } else {
+            j += p;
+            k = 1;
+          }
+        } else {
+          max_suffix = j++;
+          k = p = 1;
+        }
+      }
+      suffix[reverse] = max_suffix + 1;
+      period[reverse] = p;
+    }
+    const int r = suffix[1] >= suffix[0];
+    suffix_ = suffix[r];
+    period_ = period[r];
+
+    // If the needle is periodic, matching can remember the part of the
+    // previous attempt that is known to match. Otherwise any shift that
+    // is larger than both halves is safe.
+    periodic_ = suffix_ + period_ <= m
+        && traits_type::compare(needle_.data(), needle_.data() + period_,
+                                suffix_) == 0;
+    if (!periodic_)
+      period_ = std::max(suffix_, m - suffix_) + 1;
+  }
+
+  size_type
+  two_way(const CharT* hay, size_type n) const noexcept
+  {
+    const CharT* const needle = needle_.data();
+    const size_type m = needle_.size();
+    size_type memory = 0;
+    for (size_type j = 0; j + m <= n;) {
+      // Match the right half from left to right.
+      size_type i = periodic_ ? std::max(suffix_, memory) : suffix_;
+      while (i < m && traits_type::eq(needle[i], hay[i + j]))
+        ++i;
+      if (i < m) {
+        j += i - suffix_ + 1;
+        memory = 0;
+        continue;
+      }
+      // Match the left half from right to left.
+      const size_type low = periodic_ ? memory : 0;
+      i = suffix_;
+      while (i > low && traits_type::eq(needle[i - 1], hay[i - 1 + j]))
+        --i;
+      if (i <= low)
+        return j;
+      j += period_;
+      memory = periodic_ ? m - period_ : 0;
+    }
+    return view_type::npos;
+  }
+
+  view_type needle_;
+  algorithm algorithm_ = algorithm::kernel;
+  size_type suffix_ = 0;
+  size_type period_ = 0;
+  bool periodic_ = false;
+  // The Horspool shift for every byte, only used for char views.
+  std::array<size_type, detail::is_default_char_v<CharT, Traits> ? 256 : 0>
+      shift_ = {};
+};
+
+using searcher = basic_searcher<char>;
+using wsearcher = basic_searcher<wchar_t>;
+using u16searcher = basic_searcher<char16_t>;
+using u32searcher = basic_searcher<char32_t>;
+
+} // namespace bev
@@ -0,0 +1,531 @@
+// A view of a string that is stored in multiple non-contiguous chunks, for
+// example the pages of a ring buffer or the iovecs of a scatter read.
+//
+//     bev::string_view pages[] = {page1, page2, page3};
+//     bev::segmented_string_view request{pages};
+//     auto end = request.find("\r\n\r\n");
+//     if (end != bev::segmented_string_view::npos) {
+//       auto head = request.substr(0, end);
+//       if (head.contiguous())
+//         parse_head(head.view());
+//     }
+//
+// The searches work across chunk boundaries without copying the data. The
+// chunks themselves are not owned, so the array of chunks has to outlive the
+// view, and every search within a chunk uses the corresponding member
+// function of `basic_string_view`.
+
+#pragma once
+
+#include <bev/string_view.hpp>
+
+#include <iterator>
+#include <stdexcept>
+
+namespace bev {
+
+  /**
+   *  @brief  A view of a sequence of basic_string_view chunks.
+   *
+   *  @tparam CharT   Type of character
+   *  @tparam Traits  Traits for character type
+   *
+   *  Positions and lengths are relative to the concatenation of all chunks,
+   *  and `substr()` returns another segmented view without copying the
+   *  array of chunks, only trimming the first and the last one.
+   */
+template<typename CharT, typename Traits = std::char_traits<CharT>>
+class basic_segmented_string_view
+{
+public:
+  using view_type       = basic_string_view<CharT, Traits>;
+  using traits_type     = Traits;
+  using value_type      = CharT;
+  using const_reference = const CharT&;
+  using size_type       = size_t;
+  using difference_type = ptrdiff_t;
+
+  static constexpr size_type npos = size_type(-1);
+
+  class const_iterator;
+  using iterator = const_iterator;
+
+  constexpr
+  basic_segmented_string_view() noexcept = default;
+
+  constexpr
+  basic_segmented_string_view(const view_type* chunks, size_type count) noexcept
+    : chunks_{chunks}, count_{count}
+  {
+    for (size_type i = 0; i < count; ++i)
+      size_ += chunks[i].size();
+    if (count_ > 0)
+      last_size_ = chunks[count_ - 1].size();
+  }
+
+  // Any contiguous container of chunks, like an array or a
+  // `std::vector<view_type>`.
+  template<typename Container,
+           typename = std::enable_if_t<std::is_convertible_v<
+               decltype(std::data(std::declval<const Container&>())),
+               const view_type*>>>
+  constexpr
+  basic_segmented_string_view(const Container& chunks) noexcept
+    : basic_segmented_string_view{std::data(chunks), std::size(chunks)}
+  { }
+
+  // [segmented.string.view.iterators], iterator support
+
+  const_iterator
+  begin() const noexcept
+  { return const_iterator{*this}; }
+
+  const_iterator
+  end() const noexcept
+  { return const_iterator{}; }
+
+  const_iterator
+  cbegin() const noexcept
+  { return this->begin(); }
+
+  const_iterator
+  cend() const noexcept
+  { return this->end(); }
+
+  // [segmented.string.view.capacity], capacity
+
+  constexpr size_type
+  size() const noexcept
+  { return size_; }
+
+  constexpr size_type
+  length() const noexcept
+  { return size_; }
+
+  [[nodiscard]] constexpr bool
+  empty() const noexcept
+  { return size_ == 0; }
+
+  // [segmented.string.view.chunks], chunk access
+
+  // The number of chunks, including empty ones.
+  constexpr size_type
+  chunk_count() const noexcept
+  { return count_; }
+
+  // The chunk with index `i`, trimmed to the part that belongs to the view.
+  constexpr view_type
+  chunk(size_type i) const noexcept
+  {
+    view_type c = chunks_[i];
+    const size_type begin = i == 0 ? first_offset_ : 0;
+    if (i + 1 == count_)
+      c.remove_suffix(c.size() - begin - last_size_);
+    c.remove_prefix(begin);
+    return c;
+  }
+
+  // Whether the view lies within a single chunk, so that `view()` can
+  // return it.
+  constexpr bool
+  contiguous() const noexcept
+  {
+    size_type nonempty = 0;
+    for (size_type i = 0; i < count_ && nonempty < 2; ++i)
+      nonempty += !this->chunk(i).empty();
+    return nonempty < 2;
+  }
+
+  // Returns the view as a plain view into its only non-empty chunk. The
+  // result keeps the safederef flag of the chunk, so `is_cstring()` still
+  // works for a result that ends where the chunk ends.
+  constexpr view_type
+  view() const
+  {
+    view_type result;
+    for (size_type i = 0; i < count_; ++i) {
+      const view_type c = this->chunk(i);
+      if (c.empty())
+        continue;
+      if (!result.empty())
+        throw std::logic_error("segmented_string_view::view: not contiguous");
+      result = c;
+    }
+    return result;
+  }
+
+  // [segmented.string.view.access], element access
+
+  constexpr const_reference
+  operator[](size_type pos) const noexcept
+  {
+    size_type i = 0;
+    for (; pos >= this->chunk(i).size(); ++i)
+      pos -= this->chunk(i).size();
+    return this->chunk(i)[pos];
+  }
+
+  constexpr const_reference
+  at(size_type pos) const
+  {
+    if (pos >= size_)
+      throw std::out_of_range("segmented_string_view::at");
+    return (*this)[pos];
+  }
+
+  // [segmented.string.view.ops], string operations
+
+  size_type
+  copy(CharT* str, size_type n, size_type pos = 0) const
+  {
+    if (pos > size_)
+      throw std::out_of_range("segmented_string_view::copy");
+    const basic_segmented_string_view part = this->substr(pos, n);
+    for (size_type i = 0; i < part.count_; ++i) {
+      const view_type c = part.chunk(i);
+      traits_type::copy(str, c.data(), c.size());
+      str += c.size();
+    }
+    return part.size_;
+  }
+
+  constexpr basic_segmented_string_view
+  substr(size_type pos = 0, size_type n = npos) const
+  {
+    if (pos > size_)
+      throw std::out_of_range("segmented_string_view::substr");
+    const size_type rlen = std::min(n, size_ - pos);
+    basic_segmented_string_view result;
+    if (count_ == 0)
+      return result;
+
+    size_type first = 0;
+    while (first + 1 < count_ && pos >= this->chunk(first).size()) {
+      pos -= this->chunk(first).size();
+      ++first;
+    }
+    size_type last = first;
+    size_type remaining = rlen + pos;
+    while (last + 1 < count_ && remaining > this->chunk(last).size()) {
+      remaining -= this->chunk(last).size();
+      ++last;
+    }
+
+    result.chunks_ = chunks_ + first;
+    result.count_ = last - first + 1;
+    result.first_offset_ = pos + (first == 0 ? first_offset_ : 0);
+    result.last_size_ = first == last ? rlen : remaining;
+    result.size_ = rlen;
+    return result;
+  }
+
+  constexpr int
+  compare(const basic_segmented_string_view& str) const noexcept
+  {
+    size_type i = 0, j = 0, x = 0, y = 0;
+    for (;;) {
+      while (i < count_ && x == this->chunk(i).size())
+        ++i, x = 0;
+      while (j < str.count_ && y == str.chunk(j).size())
+        ++j, y = 0;
+      const bool x_done = i == count_;
+      const bool y_done = j == str.count_;
+      if (x_done || y_done)
+        return int(y_done) - int(x_done);
+      const view_type a = this->chunk(i);
+      const view_type b = str.chunk(j);
+      const size_type len = std::min(a.size() - x, b.size() - y);
+      const int ret = traits_type::compare(a.data() + x, b.data() + y, len);
+      if (ret != 0)
+        return ret;
+      x += len;
+      y += len;
+    }
+  }
+
+  constexpr int
+  compare(view_type str) const noexcept
+  { return this->compare(basic_segmented_string_view{&str, 1}); }
+
+  constexpr bool
+  starts_with(view_type x) const noexcept
+  { return x.size() <= size_ && this->matches_at(0, 0, x); }
+
+  constexpr bool
+  starts_with(CharT x) const noexcept
+  { return !this->empty() && traits_type::eq((*this)[0], x); }
+
+  // Returns the position of the first occurrence of `str` at or after `pos`.
+  // Occurrences that span a chunk boundary are found by comparing the last
+  // `str.size() - 1` positions of each chunk individually.
+  constexpr size_type
+  find(view_type str, size_type pos = 0) const noexcept
+  {
+    const size_type n = str.size();
+    if (n == 0)
+      return pos <= size_ ? pos : npos;
+
+    size_type base = 0;
+    for (size_type i = 0; i < count_; ++i) {
+      const view_type c = this->chunk(i);
+      if (pos < base + c.size()) {
+        const size_type from = pos > base ? pos - base : 0;
+        const size_type ret = c.find(str, from);
+        if (ret != view_type::npos)
+          return base + ret;
+        // Any match that starts earlier is found by `c.find()` above.
+        size_type s = c.size() >= n ? c.size() - n + 1 : 0;
+        for (s = std::max(s, from); s < c.size(); ++s)
+          if (base + s + n <= size_ && traits_type::eq(c[s], str[0])
+              && this->matches_at(i, s, str))
+            return base + s;
+      }
+      base += c.size();
+    }
+    return npos;
+  }
+
+  constexpr size_type
+  find(CharT c, size_type pos = 0) const noexcept
+  {
+    size_type base = 0;
+    for (size_type i = 0; i < count_; ++i) {
+      const view_type chunk = this->chunk(i);
+      if (pos < base + chunk.size()) {
+        const size_type ret = chunk.find(c, pos > base ? pos - base : 0);
+        if (ret != view_type::npos)
+          return base + ret;
+      }
+      base += chunk.size();
+    }
+    return npos;
+  }
+
+  constexpr size_type
+  find(const CharT* str, size_type pos, size_type n) const noexcept
+  { return this->find(view_type(str, n), pos); }
+
+  constexpr size_type
+  find(const CharT* str, size_type pos = 0) const noexcept
+  { return this->find(view_type(str), pos); }
+
+  constexpr size_type
+  find_first_of(view_type str, size_type pos = 0) const noexcept
+  {
+    if constexpr (detail::is_default_char_v<CharT, Traits>) {
+      if (str.size() > 1)
+        return this->find_first_of(char_set{str}, pos);
+    }
+    return this->find_in_chunks(pos, [&](view_type c, size_type from) {
+      return c.find_first_of(str, from);
+    });
+  }
+
+  constexpr size_type
+  find_first_of(CharT c, size_type pos = 0) const noexcept
+  { return this->find(c, pos); }
+
+  constexpr size_type
+  find_first_of(const CharT* str, size_type pos, size_type n) const noexcept
+  { return this->find_first_of(view_type(str, n), pos); }
+
+  constexpr size_type
+  find_first_of(const CharT* str, size_type pos = 0) const noexcept
+  { return this->find_first_of(view_type(str), pos); }
+
+  constexpr size_type
+  find_first_of(const char_set& set, size_type pos = 0) const noexcept
+  {
+    return this->find_in_chunks(pos, [&](view_type c, size_type from) {
+      return c.find_first_of(set, from);
+    });
+  }
+
+  constexpr size_type
+  find_first_not_of(const char_set& set, size_type pos = 0) const noexcept
+  {
+    return this->find_in_chunks(pos, [&](view_type c, size_type from) {
+      return c.find_first_not_of(set, from);
+    });
+  }
+
+private:
+  // Whether `str` occurs at offset `pos` of chunk `i`, possibly continuing
+  // into the following chunks.
+  constexpr bool
+  matches_at(size_type i, size_type pos, view_type str) const noexcept
+  {
+    size_type k = 0;
+    for (; i < count_ && k < str.size(); ++i, pos = 0) {
+      const view_type c = this->chunk(i);
+      const size_type len = std::min(c.size() - pos, str.size() - k);
+      if (traits_type::compare(c.data() + pos, str.data() + k, len) != 0)
+        return false;
+      k += len;
+    }
+    return k == str.size();
+  }
+
+  // Applies `find` to every chunk that ends after `pos`, and returns the
+  // first result that isn't `npos`, relative to the whole view.
+  template<typename Find>
+  constexpr size_type
+  find_in_chunks(size_type pos, Find find) const noexcept
+  {
+    size_type base = 0;
+    for (size_type i = 0; i < count_; ++i) {
+      const view_type c = this->chunk(i);
+      if (pos < base + c.size()) {
+        const size_type ret = find(c, pos > base ? pos - base : 0);
+        if (ret != view_type::npos)
+          return base + ret;
+      }
+      base += c.size();
+    }
+    return npos;
+  }
+
+  const view_type* chunks_ = nullptr;
+  size_type count_ = 0;
+  // Offset of the view into the first chunk.
+  size_type first_offset_ = 0;
+  // Length of the part of the last chunk that belongs to the view, counted
+  // from `first_offset_` if there is only one chunk.
+  size_type last_size_ = 0;
+  size_type size_ = 0;
+};
+
+  /**
+   *  @brief  A forward iterator over the characters of all chunks.
+   *
+   *  The iterator only refers to the array of chunks, so it stays valid
+   *  after the segmented view it was obtained from goes out of scope.
+   */
+template<typename CharT, typename Traits>
+class basic_segmented_string_view<CharT, Traits>::const_iterator
+{
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type        = CharT;
+  using difference_type   = ptrdiff_t;
+  using pointer           = const CharT*;
+  using reference         = const CharT&;
+
+  constexpr
+  const_iterator() noexcept = default;
+
+  constexpr reference
+  operator*() const noexcept
+  { return *p_; }
+
+  constexpr pointer
+  operator->() const noexcept
+  { return p_; }
+
+  constexpr const_iterator&
+  operator++() noexcept
+  {
+    if (++p_ == end_)
+      this->skip_empty();
+    return *this;
+  }
+
+  constexpr const_iterator
+  operator++(int) noexcept
+  {
+    const_iterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  friend constexpr bool
+  operator==(const const_iterator& x, const const_iterator& y) noexcept
+  { return x.p_ == y.p_ && x.chunk_ == y.chunk_; }
+
+  friend constexpr bool
+  operator!=(const const_iterator& x, const const_iterator& y) noexcept
+  { return !(x == y); }
+
+private:
+  friend class basic_segmented_string_view;
+
+  constexpr explicit
+  const_iterator(const basic_segmented_string_view& sv) noexcept
+  {
+    if (sv.count_ == 0)
+      return;
+    const view_type first = sv.chunk(0);
+    const view_type last = sv.chunk(sv.count_ - 1);
+    chunk_ = sv.chunks_;
+    last_chunk_ = sv.chunks_ + (sv.count_ - 1);
+    last_end_ = last.data() + last.size();
+    p_ = first.data();
+    end_ = sv.count_ == 1 ? last_end_ : p_ + first.size();
+    if (p_ == end_)
+      this->skip_empty();
+  }
+
+  // Moves to the start of the next non-empty chunk, or becomes the end
+  // iterator.
+  constexpr void
+  skip_empty() noexcept
+  {
+    while (p_ == end_) {
+      if (chunk_ == last_chunk_) {
+        chunk_ = nullptr;
+        p_ = end_ = nullptr;
+        return;
+      }
+      ++chunk_;
+      p_ = chunk_->data();
+      end_ = chunk_ == last_chunk_ ? last_end_ : p_ + chunk_->size();
+    }
+  }
+
+  const view_type* chunk_ = nullptr;
+  const view_type* last_chunk_ = nullptr;
+  const CharT* last_end_ = nullptr;
+  const CharT* p_ = nullptr;
+  const CharT* end_ = nullptr;
+};
+
+template<typename CharT, typename Traits>
+constexpr bool
+operator==(const basic_segmented_string_view<CharT, Traits>& x,
+           const basic_segmented_string_view<CharT, Traits>& y) noexcept
+{ return x.size() == y.size() && x.compare(y) == 0; }
+
+template<typename CharT, typename Traits>
+constexpr bool
+operator==(const basic_segmented_string_view<CharT, Traits>& x,
+           detail::identity<basic_string_view<CharT, Traits>> y) noexcept
+{ return x.size() == y.size() && x.compare(y) == 0; }
+
+template<typename CharT, typename Traits>
+constexpr bool
+operator==(detail::identity<basic_string_view<CharT, Traits>> x,
+           const basic_segmented_string_view<CharT, Traits>& y) noexcept
+{ return y == x; }
+
+template<typename CharT, typename Traits>
+constexpr bool
+operator!=(const basic_segmented_string_view<CharT, Traits>& x,
+           const basic_segmented_string_view<CharT, Traits>& y) noexcept
+{ return !(x == y); }
+
+template<typename CharT, typename Traits>
+constexpr bool
+operator!=(const basic_segmented_string_view<CharT, Traits>& x,
+           detail::identity<basic_string_view<CharT, Traits>> y) noexcept
+{ return !(x == y); }
+
+template<typename CharT, typename Traits>
+constexpr bool
+operator!=(detail::identity<basic_string_view<CharT, Traits>> x,
+           const basic_segmented_string_view<CharT, Traits>& y) noexcept
+{ return !(x == y); }
+
+using segmented_string_view = basic_segmented_string_view<char>;
+using wsegmented_string_view = basic_segmented_string_view<wchar_t>;
+
+} // namespace bev
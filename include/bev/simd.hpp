@@ -0,0 +1,48 @@
+// Runtime selection of the vectorized kernels used by `bev::basic_string_view`.
+//
+// The header-only `bev::string_view` target selects the kernels at compile
+// time, based on the instruction sets enabled for each translation unit. The
+// compiled `bev::string_view_simd` target instead builds the kernels for all
+// instruction sets supported by the compiler, and picks the best one that the
+// CPU supports the first time a kernel is called. This allows shipping a
+// single binary built for the baseline instruction set.
+//
+// The environment variable `BEV_STRING_VIEW_ISA` overrides the choice with
+// one of the names returned by `isa_name()`, for example for benchmarking:
+//
+//     BEV_STRING_VIEW_ISA=sse2 ./sv_bench
+//
+// The functions below can only be used when linking against
+// `bev::string_view_simd`.
+
+#pragma once
+
+#include <bev/detail/simd.hpp>
+
+#if !defined(BEV_STRING_VIEW_RUNTIME_DISPATCH)
+#  error "bev/simd.hpp requires linking against bev::string_view_simd"
+#endif
+
+namespace bev {
+
+using isa_level = detail::isa_level;
+
+// Returns the instruction set of the kernels that are currently in use.
+isa_level
+active_isa() noexcept;
+
+// Whether the kernels for `level` are part of the library and are supported
+// by the CPU.
+bool
+isa_supported(isa_level level) noexcept;
+
+// Switches to the kernels for `level`, or returns false and keeps the current
+// ones if `level` is not supported.
+bool
+force_isa(isa_level level) noexcept;
+
+// Returns the name of `level`, as accepted by `BEV_STRING_VIEW_ISA`.
+const char*
+isa_name(isa_level level) noexcept;
+
+} // namespace bev
@@ -0,0 +1,348 @@
+// A sorted set of views for large, rarely changing key sets such as symbol
+// tables and routing prefixes, optimized for lookups:
+//
+//     const bev::sorted_view_set routes{route_names.begin(), route_names.end()};
+//     if (routes.contains(path))
+//       ...
+//     // All routes that start with "/api/v2/".
+//     for (auto it = routes.lower_bound_prefix("/api/v2/"_sv);
+//          it != routes.end() && it->starts_with("/api/v2/"_sv); ++it)
+//       ...
+//
+// Next to every key, the set stores the 8 bytes after the prefix that all
+// keys share as a big-endian integer, so that most comparisons of a search
+// are a single integer comparison, and the characters of a key are only
+// read when its 8 bytes are equal to those of the searched string. The
+// cached integers are stored on their own in the Eytzinger layout, the
+// breadth-first order of a complete binary search tree: the nodes of the
+// first levels of every search share a few cache lines, the search loop
+// has no unpredictable branches, and the nodes a few levels further down
+// are prefetched while the current ones are compared.
+//
+// Construction sorts the keys by a radix sort of their cached integers,
+// and only compares the keys with equal integers. The set doesn't own the
+// characters of its keys, which have to outlive it.
+
+#pragma once
+
+#include <bev/string_view.hpp>
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <vector>
+
+namespace bev {
+
+namespace detail {
+
+// The `n` bytes at `p` as a big-endian integer, padded with zero bytes to 8,
+// so that integers compare like the strings do.
+inline uint64_t
+load_prefix_(const char* p, size_t n) noexcept
+{
+  if (n >= 8) {
+    const uint64_t v = load_le_<uint64_t>(p);
+    return __builtin_bswap64(v);
+  }
+  uint64_t result = 0;
+  for (size_t i = 0; i < n; ++i)
+    result |= uint64_t(static_cast<unsigned char>(p[i])) << (56 - 8 * i);
+  return result;
+}
+
+// A key and its cached prefix, while the set is built in sorted order.
+struct prefixed_view_
+{
+  uint64_t prefix;
+  basic_string_view<char> key;
+};
+
+// Sorts by `prefix` with one counting pass per byte, least significant
+// first, and skips the bytes that are the same for all entries.
+inline void
+radix_sort_prefixes_(std::vector<prefixed_view_>& entries)
+{
+  const size_t n = entries.size();
+  std::vector<size_t> counts(8 * 256);
+  for (const prefixed_view_& e : entries)
+    for (unsigned byte = 0; byte < 8; ++byte)
+      ++counts[byte * 256 + ((e.prefix >> (8 * byte)) & 0xff)];
+
+  std::vector<prefixed_view_> buffer(n);
+  for (unsigned byte = 0; byte < 8; ++byte) {
+    size_t* const count = counts.data() + byte * 256;
+    if (count[(entries[0].prefix >> (8 * byte)) & 0xff] == n)
+      continue;
+    size_t offset = 0;
+    for (size_t i = 0; i < 256; ++i) {
+      const size_t c = count[i];
+      count[i] = offset;
+      offset += c;
+    }
+    for (const prefixed_view_& e : entries)
+      buffer[count[(e.prefix >> (8 * byte)) & 0xff]++] = e;
+    entries.swap(buffer);
+  }
+}
+
+} // namespace detail
+
+  /**
+   *  @brief  An immutable sorted set of views, searched through cached
+   *          8-byte prefixes.
+   *
+   *  Orders keys like `bev::string_view` does, and iterates over them in
+   *  that order. Keys that appear more than once are only stored once.
+   */
+class sorted_view_set
+{
+public:
+  using key_type   = basic_string_view<char>;
+  using value_type = key_type;
+  using size_type  = size_t;
+
+  class const_iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = key_type;
+    using difference_type   = ptrdiff_t;
+    using pointer           = const key_type*;
+    using reference         = const key_type&;
+
+    constexpr
+    const_iterator() noexcept = default;
+
+    reference
+    operator*() const noexcept
+    { return set_->keys_[node_]; }
+
+    pointer
+    operator->() const noexcept
+    { return &set_->keys_[node_]; }
+
+    // The next node in order is the leftmost one of the right subtree, or
+    // else the parent of the first ancestor that is a left child.
+    const_iterator&
+    operator++() noexcept
+    {
+      const size_type n = set_->size();
+      if (2 * node_ + 1 <= n) {
+        node_ = 2 * node_ + 1;
+        while (2 * node_ <= n)
+          node_ *= 2;
+      } else {
+        node_ >>= detail::countr_zero(~uint64_t(node_)) + 1;
+      }
+      return *this;
+    }
+
+    const_iterator
+    operator++(int) noexcept
+    {
+      const_iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    friend bool
+    operator==(const_iterator x, const_iterator y) noexcept
+    { return x.node_ == y.node_; }
+
+    friend bool
+    operator!=(const_iterator x, const_iterator y) noexcept
+    { return x.node_ != y.node_; }
+
+  private:
+    friend class sorted_view_set;
+
+    const_iterator(const sorted_view_set* set, size_type node) noexcept
+      : set_{set}, node_{node}
+    { }
+
+    const sorted_view_set* set_ = nullptr;
+    // Index into the Eytzinger layout, where 0 is the end.
+    size_type node_ = 0;
+  };
+
+  using iterator = const_iterator;
+
+  sorted_view_set() = default;
+
+  template<typename InputIt>
+  sorted_view_set(InputIt first, InputIt last)
+  { this->build(std::vector<key_type>(first, last)); }
+
+  sorted_view_set(std::initializer_list<key_type> keys)
+  { this->build(std::vector<key_type>(keys)); }
+
+  size_type
+  size() const noexcept
+  { return keys_.empty() ? 0 : keys_.size() - 1; }
+
+  [[nodiscard]] bool
+  empty() const noexcept
+  { return this->size() == 0; }
+
+  const_iterator
+  begin() const noexcept
+  {
+    if (this->empty())
+      return this->end();
+    size_type node = 1;
+    while (2 * node <= this->size())
+      node *= 2;
+    return const_iterator{this, node};
+  }
+
+  const_iterator
+  end() const noexcept
+  { return const_iterator{this, 0}; }
+
+  // The first key that is not less than `str`.
+  const_iterator
+  lower_bound(key_type str) const noexcept
+  { return const_iterator{this, this->search(str)}; }
+
+  const_iterator
+  find(key_type str) const noexcept
+  {
+    const size_type node = this->search(str);
+    return node && keys_[node] == str ? const_iterator{this, node}
+                                      : this->end();
+  }
+
+  bool
+  contains(key_type str) const noexcept
+  { return this->find(str) != this->end(); }
+
+  // The first key that starts with `prefix`, or `end()` if there is none.
+  // All keys that start with `prefix` follow it.
+  const_iterator
+  lower_bound_prefix(key_type prefix) const noexcept
+  {
+    const size_type node = this->search(prefix);
+    return node && keys_[node].starts_with(prefix)
+        ? const_iterator{this, node} : this->end();
+  }
+
+  // The length of the prefix that all keys share, which the cached bytes
+  // follow.
+  size_type
+  common_prefix_length() const noexcept
+  { return common_.size(); }
+
+private:
+  void
+  build(std::vector<key_type> keys)
+  {
+    if (keys.empty())
+      return;
+    common_ = keys[0];
+    for (key_type key : keys) {
+      size_type i = 0;
+      const size_type n = std::min(common_.size(), key.size());
+      while (i < n && common_[i] == key[i])
+        ++i;
+      common_ = key_type{common_.data(), i};
+    }
+
+    std::vector<detail::prefixed_view_> sorted;
+    sorted.reserve(keys.size());
+    for (key_type key : keys)
+      sorted.push_back({this->prefix_of(key), key});
+    keys.clear();
+    keys.shrink_to_fit();
+    detail::radix_sort_prefixes_(sorted);
+    for (auto run = sorted.begin(); run != sorted.end(); ) {
+      const auto next = std::find_if(run + 1, sorted.end(),
+          [&](const detail::prefixed_view_& e) { return e.prefix != run->prefix; });
+      if (next - run > 1)
+        std::sort(run, next, [](const detail::prefixed_view_& x,
+                                const detail::prefixed_view_& y) {
+          return x.key < y.key;
+        });
+      run = next;
+    }
+    sorted.erase(std::unique(sorted.begin(), sorted.end(),
+        [](const detail::prefixed_view_& x, const detail::prefixed_view_& y) {
+          return x.prefix == y.prefix && x.key == y.key;
+        }), sorted.end());
+
+    prefixes_.assign(sorted.size() + 1, 0);
+    keys_.assign(sorted.size() + 1, key_type{});
+    size_type next = 0;
+    this->fill(sorted, next, 1);
+  }
+
+  // Fills the subtree at `node` with the sorted entries from `next` on, in
+  // order.
+  void
+  fill(const std::vector<detail::prefixed_view_>& sorted, size_type& next,
+       size_type node) noexcept
+  {
+    if (node > sorted.size())
+      return;
+    this->fill(sorted, next, 2 * node);
+    prefixes_[node] = sorted[next].prefix;
+    keys_[node] = sorted[next].key;
+    ++next;
+    this->fill(sorted, next, 2 * node + 1);
+  }
+
+  // The cached bytes of a key, which starts with `common_`.
+  uint64_t
+  prefix_of(key_type key) const noexcept
+  {
+    const size_type skip = common_.size();
+    return detail::load_prefix_(key.data() + skip,
+                                std::min<size_type>(key.size() - skip, 8));
+  }
+
+  // Whether `key` is less than `str`, whose cached bytes are equal.
+  bool
+  tail_less(key_type key, key_type str) const noexcept
+  {
+    const size_type skip = std::min({common_.size() + 8, key.size(),
+                                     str.size()});
+    return key_type{key.data() + skip, key.size() - skip}
+         < key_type{str.data() + skip, str.size() - skip};
+  }
+
+  // The node of the first key that is not less than `str`, or 0.
+  size_type
+  search(key_type str) const noexcept
+  {
+    const size_type n = this->size();
+    if (n == 0)
+      return 0;
+    // Strings that don't start with the common prefix are less or greater
+    // than all keys.
+    const size_type skip = common_.size();
+    const key_type head = str.substr(0, skip);
+    if (head != common_)
+      return head < common_ ? this->begin().node_ : 0;
+
+    const uint64_t prefix = this->prefix_of(str);
+    const uint64_t* const prefixes = prefixes_.data();
+    size_type node = 1;
+    while (node <= n) {
+      // The prefixes of the 8 descendants three levels down are 64 bytes.
+      __builtin_prefetch(prefixes + std::min(8 * node, n));
+      const uint64_t p = prefixes[node];
+      const bool less = p < prefix
+                     || (p == prefix && this->tail_less(keys_[node], str));
+      node = 2 * node + less;
+    }
+    // Back up to the last node where the search went left.
+    return node >> (detail::countr_zero(~uint64_t(node)) + 1);
+  }
+
+  // Both indexed by node, starting at 1.
+  std::vector<uint64_t> prefixes_;
+  std::vector<key_type> keys_;
+  key_type common_;
+};
+
+} // namespace bev
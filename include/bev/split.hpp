@@ -0,0 +1,267 @@
+// A lazy range of the tokens of a view, separated by any of a set of
+// delimiter characters:
+//
+//     for (bev::string_view field : bev::split(line, ",;"))
+//       handle(field);
+//
+//     // Python-style `line.split(None, 1)`.
+//     auto words = bev::split(line, " \t", {bev::skip_empty, 1});
+//
+// No characters are copied, every token is a view into the original one. All
+// tokens except the last one are followed by a delimiter, so they have the
+// safederef flag set. The last token keeps the flag of the original view.
+//
+// For `char` views, the iterator classifies the characters in blocks of 64
+// with the vectorized `char_set` lookup, and keeps the resulting bitmask
+// until all delimiters in the block are consumed. Without byte shuffles (e.g.
+// with only SSE2) and for other character types, it uses `find_first_of()`.
+
+#pragma once
+
+#include <bev/string_view.hpp>
+
+#include <iterator>
+#include <type_traits>
+
+#if defined(__cpp_lib_ranges)
+#  include <ranges>
+#endif
+
+namespace bev {
+
+// Tag type for `split_options` that skips the empty tokens between adjacent
+// delimiters and at both ends of the view.
+struct skip_empty_t { explicit skip_empty_t() = default; };
+inline constexpr skip_empty_t skip_empty{};
+
+struct split_options
+{
+  constexpr
+  split_options() noexcept = default;
+
+  constexpr
+  split_options(size_t max) noexcept
+    : max_splits{max}
+  { }
+
+  constexpr
+  split_options(skip_empty_t, size_t max = size_t(-1)) noexcept
+    : skip_empty{true}, max_splits{max}
+  { }
+
+  bool skip_empty = false;
+  // After this many delimiters, the rest of the view is returned as the last
+  // token, without looking for further delimiters in it.
+  size_t max_splits = size_t(-1);
+};
+
+  /**
+   *  @brief  The range returned by `bev::split()`.
+   *
+   *  @tparam CharT   Type of character
+   *  @tparam Traits  Traits for character type
+   *
+   *  The iterators refer to the range, which has to outlive them.
+   */
+template<typename CharT, typename Traits = std::char_traits<CharT>>
+class basic_split_range
+#if defined(__cpp_lib_ranges)
+  : public std::ranges::view_interface<basic_split_range<CharT, Traits>>
+#endif
+{
+  static constexpr bool is_bytes = detail::is_default_char_v<CharT, Traits>;
+
+  // A `char_set` for byte views, otherwise a view of the delimiters.
+  using delimiters_type =
+      std::conditional_t<is_bytes, char_set, basic_string_view<CharT, Traits>>;
+
+public:
+  using view_type = basic_string_view<CharT, Traits>;
+  using size_type = size_t;
+
+  class iterator;
+
+  constexpr
+  basic_split_range() noexcept = default;
+
+  basic_split_range(view_type str, view_type delims,
+                    split_options options = {}) noexcept
+    : str_{str}, delims_{delims}, options_{options}
+  { }
+
+  template<bool B = is_bytes, typename = std::enable_if_t<B>>
+  basic_split_range(view_type str, const char_set& delims,
+                    split_options options = {}) noexcept
+    : str_{str}, delims_{delims}, options_{options}
+  { }
+
+  iterator
+  begin() const noexcept
+  { return iterator{this}; }
+
+  iterator
+  end() const noexcept
+  { return iterator{}; }
+
+private:
+  view_type str_;
+  delimiters_type delims_;
+  split_options options_;
+};
+
+template<typename CharT, typename Traits>
+class basic_split_range<CharT, Traits>::iterator
+{
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type        = view_type;
+  using difference_type   = std::ptrdiff_t;
+  using pointer           = const view_type*;
+  using reference         = const view_type&;
+
+  // The end iterator.
+  constexpr
+  iterator() noexcept = default;
+
+  reference
+  operator*() const noexcept
+  { return token_; }
+
+  pointer
+  operator->() const noexcept
+  { return &token_; }
+
+  iterator&
+  operator++() noexcept
+  {
+    this->advance();
+    return *this;
+  }
+
+  iterator
+  operator++(int) noexcept
+  {
+    iterator result = *this;
+    this->advance();
+    return result;
+  }
+
+  // Iterators of the same range are equal if they are at the same token, or
+  // both at the end.
+  friend bool
+  operator==(const iterator& x, const iterator& y) noexcept
+  {
+    return x.range_ == y.range_
+        && (!x.range_ || x.token_.data() == y.token_.data());
+  }
+
+  friend bool
+  operator!=(const iterator& x, const iterator& y) noexcept
+  { return !(x == y); }
+
+private:
+  friend class basic_split_range;
+
+  explicit
+  iterator(const basic_split_range* range) noexcept
+    : range_{range}
+  { this->advance(); }
+
+  void
+  advance() noexcept
+  {
+    const view_type str = range_->str_;
+    const split_options& options = range_->options_;
+    if (next_ == npos) {
+      range_ = nullptr;
+      return;
+    }
+    if (options.skip_empty) {
+      next_ = this->find_delimiter<true>(next_);
+      if (next_ == npos) {
+        range_ = nullptr;
+        return;
+      }
+    }
+    const size_type end = splits_ == options.max_splits
+        ? npos : this->find_delimiter<false>(next_);
+    if (end == npos) {
+      token_ = str.substr(next_);
+      next_ = npos;
+    } else {
+      token_ = view_type{str.data() + next_, end - next_, safederef};
+      next_ = end + 1;
+      ++splits_;
+    }
+  }
+
+  // Returns the position of the first delimiter (or non-delimiter, if
+  // `Negate` is true) at or after `pos`, or `npos`.
+  template<bool Negate>
+  size_type
+  find_delimiter(size_type pos) noexcept
+  {
+    const view_type str = range_->str_;
+    if constexpr (is_bytes && detail::has_vectorized_class_bitmask) {
+      while (pos < str.size()) {
+        if (pos < block_ || pos - block_ >= 64) {
+          block_ = pos;
+          mask_ = detail::class_bitmask_kernel(
+              str.data() + pos, str.size() - pos, range_->delims_.class_);
+        }
+        const size_type valid = str.size() - block_;
+        uint64_t mask = Negate ? ~mask_ : mask_;
+        if (valid < 64)
+          mask &= (uint64_t(1) << valid) - 1;
+        mask &= ~uint64_t(0) << (pos - block_);
+        if (mask)
+          return block_ + detail::countr_zero(mask);
+        pos = block_ + 64;
+      }
+      return npos;
+    } else if constexpr (Negate) {
+      return str.find_first_not_of(range_->delims_, pos);
+    } else {
+      return str.find_first_of(range_->delims_, pos);
+    }
+  }
+
+  static constexpr size_type npos = size_type(-1);
+
+  const basic_split_range* range_ = nullptr;
+  view_type token_;
+  // The start of the next token, or `npos` after the last one.
+  size_type next_ = 0;
+  size_type splits_ = 0;
+  // The delimiters among the 64 characters starting at `block_`.
+  size_type block_ = npos;
+  uint64_t mask_ = 0;
+};
+
+// Returns a range of the tokens of `str` that are separated by any of the
+// characters in `delims`.
+template<typename CharT, typename Traits>
+basic_split_range<CharT, Traits>
+split(basic_string_view<CharT, Traits> str,
+      basic_string_view<CharT, Traits> delims, split_options options = {})
+{ return basic_split_range<CharT, Traits>{str, delims, options}; }
+
+inline basic_split_range<char>
+split(basic_string_view<char> str, basic_string_view<char> delims,
+      split_options options = {})
+{ return basic_split_range<char>{str, delims, options}; }
+
+inline basic_split_range<char>
+split(basic_string_view<char> str, const char_set& delims,
+      split_options options = {})
+{ return basic_split_range<char>{str, delims, options}; }
+
+// Returns a range of the tokens of `str` that are separated by `delim`.
+inline basic_split_range<char>
+split(basic_string_view<char> str, char delim, split_options options = {})
+{ return basic_split_range<char>{str, basic_string_view<char>{&delim, 1}, options}; }
+
+using split_range = basic_split_range<char>;
+using wsplit_range = basic_split_range<wchar_t>;
+
+} // namespace bev
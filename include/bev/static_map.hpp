@@ -0,0 +1,247 @@
+// A map from a fixed set of strings to values, using a perfect hash function
+// that is computed at compile time.
+//
+//     using namespace bev;
+//     constexpr auto verbs = make_static_map<int>({
+//       {"GET"_sv, 1}, {"HEAD"_sv, 2}, {"POST"_sv, 3}, {"PUT"_sv, 4}});
+//
+//     if (const int* verb = verbs.find(request.verb()))
+//       dispatch(*verb);
+//
+// Every lookup computes the library hash of the key once, probes exactly one
+// slot of the table, and compares the stored hash and key at that slot.
+
+#pragma once
+
+#include <bev/hashed_string_view.hpp>
+
+#include <stdexcept>
+#include <utility>
+
+namespace bev {
+
+namespace detail {
+
+// Returns the smallest power of two that is not less than `n`.
+constexpr size_t bit_ceil_(size_t n) noexcept
+{
+  size_t result = 1;
+  while (result < n)
+    result <<= 1;
+  return result;
+}
+
+} // namespace detail
+
+  /**
+   *  @brief  A perfect-hash map with a fixed set of string keys.
+   *
+   *  @tparam V          Type of the mapped values, must be a literal type
+   *                     to construct the map at compile time
+   *  @tparam N          Number of entries
+   *  @tparam Algorithm  The hash algorithm, see `bev::hash`
+   *
+   *  The keys are distributed into buckets by their hash, and for every
+   *  bucket the constructor searches for a displacement value that maps all
+   *  of its keys to distinct free slots (the "hash and displace" scheme).
+   *  Construction throws `std::invalid_argument` if a key appears twice,
+   *  which makes it ill-formed in a constant expression.
+   */
+template<typename V, size_t N, typename Algorithm = default_hash_algorithm>
+class static_map
+{
+  static_assert(N > 0, "bev::static_map needs at least one entry");
+
+public:
+  using key_type    = basic_string_view<char>;
+  using mapped_type = V;
+  using value_type  = std::pair<key_type, V>;
+  using size_type   = size_t;
+
+  static constexpr size_type bucket_count = (N + 1) / 2;
+  static constexpr size_type slot_count = detail::bit_ceil_(2 * N);
+
+  constexpr explicit
+  static_map(const value_type (&entries)[N])
+  {
+    for (size_type i = 0; i < N; ++i) {
+      keys_[i] = entries[i].first;
+      values_[i] = entries[i].second;
+    }
+    this->build();
+  }
+
+  constexpr
+  static_map(const key_type (&keys)[N], const V (&values)[N])
+  {
+    for (size_type i = 0; i < N; ++i) {
+      keys_[i] = keys[i];
+      values_[i] = values[i];
+    }
+    this->build();
+  }
+
+  [[nodiscard]] constexpr const V*
+  find(key_type key) const noexcept
+  {
+    const size_type i = this->index_of(key);
+    return i == N ? nullptr : &values_[i];
+  }
+
+  template<typename Traits>
+  [[nodiscard]] constexpr const V*
+  find(const basic_hashed_string_view<char, Traits, Algorithm>& key)
+    const noexcept
+  {
+    const size_type i = this->index_of(key.view(), key.hash());
+    return i == N ? nullptr : &values_[i];
+  }
+
+  constexpr bool
+  contains(key_type key) const noexcept
+  { return this->index_of(key) != N; }
+
+  constexpr const V&
+  at(key_type key) const
+  {
+    const size_type i = this->index_of(key);
+    if (i == N)
+      throw std::out_of_range("static_map::at");
+    return values_[i];
+  }
+
+  constexpr size_type
+  size() const noexcept
+  { return N; }
+
+  // The keys and values, in the order they were passed to the constructor.
+  constexpr const key_type*
+  keys() const noexcept
+  { return keys_; }
+
+  constexpr const V*
+  values() const noexcept
+  { return values_; }
+
+private:
+  using index_type = std::conditional_t<(N < 0xffff), uint16_t, uint32_t>;
+
+  static constexpr index_type empty_slot = index_type(-1);
+
+  // Upper bound for the displacement search, reaching it means that the
+  // keys almost certainly contain a full 64-bit hash collision.
+  static constexpr uint32_t max_displacement = 1u << 16;
+
+  static constexpr size_type
+  bucket_of(uint64_t hash) noexcept
+  { return static_cast<size_type>(hash % bucket_count); }
+
+  static constexpr size_type
+  slot_of(uint64_t hash, uint32_t displacement) noexcept
+  {
+    return static_cast<size_type>(
+        detail::wymix_(hash, 0x9e3779b97f4a7c15ull + displacement)
+        & (slot_count - 1));
+  }
+
+  // Computes the hashes, the displacements and the slots for the keys.
+  constexpr void
+  build();
+
+  // Returns the index of `key`, or `N` if it is not one of the keys.
+  constexpr size_type
+  index_of(key_type key) const noexcept
+  { return this->index_of(key, Algorithm::hash_bytes(key.data(), key.size())); }
+
+  constexpr size_type
+  index_of(key_type key, uint64_t hash) const noexcept
+  {
+    const index_type i =
+        slots_[slot_of(hash, displacements_[bucket_of(hash)])];
+    if (i == empty_slot || hashes_[i] != hash || keys_[i] != key)
+      return N;
+    return i;
+  }
+
+  key_type keys_[N] = {};
+  V values_[N] = {};
+  uint64_t hashes_[N] = {};
+  index_type slots_[slot_count] = {};
+  uint32_t displacements_[bucket_count] = {};
+};
+
+template<typename V, size_t N, typename Algorithm>
+constexpr void
+static_map<V, N, Algorithm>::build()
+{
+  size_type bucket_size[bucket_count] = {};
+  for (size_type i = 0; i < N; ++i) {
+    hashes_[i] = Algorithm::hash_bytes(keys_[i].data(), keys_[i].size());
+    ++bucket_size[bucket_of(hashes_[i])];
+  }
+  for (size_type s = 0; s < slot_count; ++s)
+    slots_[s] = empty_slot;
+
+  // Place the largest buckets first, while most of the slots are free.
+  size_type order[bucket_count] = {};
+  for (size_type b = 0; b < bucket_count; ++b) {
+    size_type j = b;
+    for (; j > 0 && bucket_size[order[j - 1]] < bucket_size[b]; --j)
+      order[j] = order[j - 1];
+    order[j] = b;
+  }
+
+  for (size_type b : order) {
+    if (bucket_size[b] == 0)
+      break;
+
+    size_type members[N] = {};
+    size_type count = 0;
+    for (size_type i = 0; i < N; ++i)
+      if (bucket_of(hashes_[i]) == b)
+        members[count++] = i;
+    for (size_type k = 0; k < count; ++k)
+      for (size_type j = 0; j < k; ++j)
+        if (keys_[members[j]] == keys_[members[k]])
+          throw std::invalid_argument("static_map: duplicate key");
+
+    size_type candidate[N] = {};
+    for (uint32_t d = 0; ; ++d) {
+      if (d == max_displacement)
+        throw std::invalid_argument("static_map: no perfect hash found");
+      bool found = true;
+      for (size_type k = 0; k < count && found; ++k) {
+        candidate[k] = slot_of(hashes_[members[k]], d);
+        found = slots_[candidate[k]] == empty_slot;
+        for (size_type j = 0; j < k && found; ++j)
+          found = candidate[j] != candidate[k];
+      }
+      if (found) {
+        displacements_[b] = d;
+        for (size_type k = 0; k < count; ++k)
+          slots_[candidate[k]] = static_cast<index_type>(members[k]);
+        break;
+      }
+    }
+  }
+}
+
+// Creates a `static_map` from an array of key-value pairs, deducing the
+// number of entries.
+template<typename V, typename Algorithm = default_hash_algorithm, size_t N>
+constexpr static_map<V, N, Algorithm>
+make_static_map(const std::pair<basic_string_view<char>, V> (&entries)[N])
+{ return static_map<V, N, Algorithm>{entries}; }
+
+// Creates a `static_map` that maps each of the `keys` to its index.
+template<typename Algorithm = default_hash_algorithm, size_t N>
+constexpr static_map<size_t, N, Algorithm>
+make_static_map(const basic_string_view<char> (&keys)[N])
+{
+  size_t values[N] = {};
+  for (size_t i = 0; i < N; ++i)
+    values[i] = i;
+  return static_map<size_t, N, Algorithm>{keys, values};
+}
+
+} // namespace bev
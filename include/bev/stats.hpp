@@ -0,0 +1,264 @@
+// Counters for the hot paths of `bev::basic_string_view`, to find out how
+// often views can be passed to C APIs without a copy, and where the time of
+// searching and hashing goes:
+//
+//     // Compile everything with -DBEV_STRING_VIEW_STATS.
+//     const bev::stats::counters c = bev::stats::snapshot();
+//     for (size_t i = 0; i < bev::stats::counter_count; ++i)
+//       metrics.gauge(std::string{"string_view."} + bev::stats::counter_names[i],
+//                     c.values[i]);
+//
+// The counters only exist if `BEV_STRING_VIEW_STATS` is defined, which has to
+// be the same for all translation units of a program. Otherwise the counting
+// compiles to nothing, and `snapshot()` returns zeros, so that exporting code
+// doesn't need to be conditional.
+//
+// Every thread counts into its own counters with relaxed atomic stores,
+// without contention. `snapshot()` adds up the counters of all threads,
+// including the ones that have exited. Counting happens outside of constant
+// evaluation only.
+//
+// The search and hash counters count the calls and the number of bytes
+// searched or hashed by `bev::string_view` with the default traits, whether
+// they run in a vectorized kernel or not. The `find_of` counters count the
+// searches for sets of characters of the `find_*_of()` family, which search
+// for single characters with `find()` and `rfind()` instead.
+
+#pragma once
+
+#include <bev/detail/simd.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(BEV_STRING_VIEW_STATS)
+#  include <algorithm>
+#  include <atomic>
+#  include <mutex>
+#  include <vector>
+#endif
+
+namespace bev {
+namespace stats {
+
+enum class counter : unsigned
+{
+  // Calls of `is_cstring()` that returned true.
+  is_cstring_true,
+  // Calls of `is_cstring()` that returned false because the view doesn't
+  // have the safederef flag, or because the character after it is not null.
+  is_cstring_no_flag,
+  is_cstring_not_null,
+  // Copies made by `basic_cstring_arg`, i.e. `c_str_or_copy()`, the bytes
+  // they copied, and how many of them were allocated on the heap.
+  cstring_copies,
+  cstring_copy_bytes,
+  cstring_heap_copies,
+  // Calls and bytes of the searches and hashes. Every `_bytes` counter
+  // directly follows its `_calls` counter.
+  find_calls,
+  find_bytes,
+  find_char_calls,
+  find_char_bytes,
+  rfind_calls,
+  rfind_bytes,
+  rfind_char_calls,
+  rfind_char_bytes,
+  find_of_calls,
+  find_of_bytes,
+  hash_calls,
+  hash_bytes,
+};
+
+inline constexpr size_t counter_count = size_t(counter::hash_bytes) + 1;
+
+// The names of the counters, indexed like `counters::values`.
+inline constexpr const char* counter_names[counter_count] = {
+  "is_cstring_true",
+  "is_cstring_no_flag",
+  "is_cstring_not_null",
+  "cstring_copies",
+  "cstring_copy_bytes",
+  "cstring_heap_copies",
+  "find_calls",
+  "find_bytes",
+  "find_char_calls",
+  "find_char_bytes",
+  "rfind_calls",
+  "rfind_bytes",
+  "rfind_char_calls",
+  "rfind_char_bytes",
+  "find_of_calls",
+  "find_of_bytes",
+  "hash_calls",
+  "hash_bytes",
+};
+
+  /**
+   *  @brief  The values of all counters at one point in time.
+   */
+struct counters
+{
+  uint64_t values[counter_count] = {};
+
+  constexpr uint64_t
+  operator[](counter c) const noexcept
+  { return values[size_t(c)]; }
+};
+
+inline constexpr bool enabled =
+#if defined(BEV_STRING_VIEW_STATS)
+    true;
+#else
+    false;
+#endif
+
+#if defined(BEV_STRING_VIEW_STATS)
+
+namespace detail {
+
+struct thread_counters;
+
+// The counters of the running threads, and the sums of the ones that have
+// exited.
+struct registry
+{
+  std::mutex mutex;
+  std::vector<const thread_counters*> threads;
+  counters retired;
+};
+
+inline registry&
+registry_() noexcept
+{
+  static registry r;
+  return r;
+}
+
+struct thread_counters
+{
+  std::atomic<uint64_t> values[counter_count] = {};
+  // Whether `snapshot()` sees the counters.
+  bool registered = false;
+
+  // Runs on the first counted call of a thread, within `noexcept` searches,
+  // so a thread that can't be registered only counts for
+  // `thread_snapshot()`.
+  thread_counters() noexcept
+  {
+    try {
+      registry& r = registry_();
+      const std::lock_guard<std::mutex> lock{r.mutex};
+      r.threads.push_back(this);
+      registered = true;
+    } catch (...) {
+    }
+  }
+
+  ~thread_counters()
+  {
+    if (!registered)
+      return;
+    registry& r = registry_();
+    const std::lock_guard<std::mutex> lock{r.mutex};
+    for (size_t i = 0; i < counter_count; ++i)
+      r.retired.values[i] += values[i].load(std::memory_order_relaxed);
+    r.threads.erase(std::find(r.threads.begin(), r.threads.end(), this));
+  }
+
+  thread_counters(const thread_counters&) = delete;
+  thread_counters& operator=(const thread_counters&) = delete;
+};
+
+inline thread_counters&
+local_() noexcept
+{
+  thread_local thread_counters c;
+  return c;
+}
+
+// Only the own thread writes its counters, so no atomic read-modify-write
+// is needed.
+inline void
+add_(size_t i, uint64_t n) noexcept
+{
+  std::atomic<uint64_t>& v = local_().values[i];
+  v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+constexpr void
+count_(counter c, uint64_t n) noexcept
+{
+#if defined(BEV_STRING_VIEW_IS_CONSTANT_EVALUATED)
+  if (!BEV_STRING_VIEW_IS_CONSTANT_EVALUATED())
+    add_(size_t(c), n);
+#else
+  (void)c;
+  (void)n;
+#endif
+}
+
+// Counts one call and `bytes` bytes for the `calls` counter.
+constexpr void
+count_call_(counter calls, uint64_t bytes) noexcept
+{
+#if defined(BEV_STRING_VIEW_IS_CONSTANT_EVALUATED)
+  if (!BEV_STRING_VIEW_IS_CONSTANT_EVALUATED()) {
+    add_(size_t(calls), 1);
+    add_(size_t(calls) + 1, bytes);
+  }
+#else
+  (void)calls;
+  (void)bytes;
+#endif
+}
+
+} // namespace detail
+
+// The sums of the counters of all threads.
+inline counters
+snapshot()
+{
+  detail::registry& r = detail::registry_();
+  const std::lock_guard<std::mutex> lock{r.mutex};
+  counters result = r.retired;
+  for (const detail::thread_counters* t : r.threads)
+    for (size_t i = 0; i < counter_count; ++i)
+      result.values[i] += t->values[i].load(std::memory_order_relaxed);
+  return result;
+}
+
+// The counters of the calling thread only.
+inline counters
+thread_snapshot() noexcept
+{
+  counters result;
+  const detail::thread_counters& t = detail::local_();
+  for (size_t i = 0; i < counter_count; ++i)
+    result.values[i] = t.values[i].load(std::memory_order_relaxed);
+  return result;
+}
+
+#  define BEV_STRING_VIEW_COUNT(name, n) \
+     ::bev::stats::detail::count_(::bev::stats::counter::name, (n))
+#  define BEV_STRING_VIEW_COUNT_CALL(name, bytes) \
+     ::bev::stats::detail::count_call_(::bev::stats::counter::name##_calls, \
+                                       (bytes))
+
+#else
+
+inline counters
+snapshot() noexcept
+{ return counters{}; }
+
+inline counters
+thread_snapshot() noexcept
+{ return counters{}; }
+
+#  define BEV_STRING_VIEW_COUNT(name, n) ((void)0)
+#  define BEV_STRING_VIEW_COUNT_CALL(name, bytes) ((void)0)
+
+#endif
+
+} // namespace stats
+} // namespace bev
@@ -0,0 +1,350 @@
+// A set of strings that stores every distinct string once, for deduplicating
+// the identifiers, keys and tags of parsed input:
+//
+//     bev::string_interner names;
+//     bev::string_view a = names.intern(line.substr(0, 8));
+//     bev::string_view b = names.intern(other_line.substr(0, 8));
+//     // Interned views are equal if and only if their pointers are.
+//     assert((a == b) == (a.data() == b.data()) && a.is_cstring());
+//
+// The characters are copied into large blocks of memory with a null
+// character after every string, so the interned views have the safederef
+// flag set and can be passed to C APIs without another copy. The set itself
+// is an open-addressing hash table with linear probing, which stores the
+// hash of every string next to it and doesn't allocate per string.
+//
+// `bev::concurrent_string_interner` distributes the strings by their hash
+// over several independently locked interners, for interning from multiple
+// threads.
+
+#pragma once
+
+#include <bev/hashed_string_view.hpp>
+
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace bev {
+
+  /**
+   *  @brief  A hash set of strings stored in an arena.
+   *
+   *  @tparam Algorithm  The hash algorithm, see `bev::hash`
+   *
+   *  The interned views stay valid until the interner is cleared or
+   *  destroyed, also when it is moved.
+   */
+template<typename Algorithm = default_hash_algorithm>
+class basic_string_interner
+{
+public:
+  using view_type   = basic_string_view<char>;
+  using hashed_type = basic_hashed_string_view<char, std::char_traits<char>,
+                                               Algorithm>;
+  using size_type   = size_t;
+
+  // The size of the blocks of memory that the strings are copied into.
+  // Strings longer than a quarter of it get a block of their own.
+  static constexpr size_type default_block_size = size_type(64) << 10;
+
+  explicit
+  basic_string_interner(size_type block_size = default_block_size) noexcept
+    : block_size_{block_size ? block_size : 1}
+  { }
+
+  // The moved-from interner is empty, and doesn't use the blocks of memory
+  // that now belong to the other one.
+  basic_string_interner(basic_string_interner&& other) noexcept
+    : slots_{std::move(other.slots_)}
+    , size_{std::exchange(other.size_, 0)}
+    , blocks_{std::move(other.blocks_)}
+    , block_size_{other.block_size_}
+    , next_{std::exchange(other.next_, nullptr)}
+    , remaining_{std::exchange(other.remaining_, 0)}
+    , arena_bytes_{std::exchange(other.arena_bytes_, 0)}
+  {
+    other.slots_.clear();
+    other.blocks_.clear();
+  }
+
+  basic_string_interner&
+  operator=(basic_string_interner&& other) noexcept
+  {
+    if (this != &other) {
+      this->clear();
+      slots_.swap(other.slots_);
+      blocks_.swap(other.blocks_);
+      block_size_ = other.block_size_;
+      size_ = std::exchange(other.size_, 0);
+      next_ = std::exchange(other.next_, nullptr);
+      remaining_ = std::exchange(other.remaining_, 0);
+      arena_bytes_ = std::exchange(other.arena_bytes_, 0);
+    }
+    return *this;
+  }
+
+  // Returns the interned copy of `str`, which is added if it is not in the
+  // set yet.
+  view_type
+  intern(view_type str)
+  { return this->intern(hashed_type{str}); }
+
+  view_type
+  intern(const hashed_type& str)
+  {
+    if ((size_ + 1) * 4 > slots_.size() * 3)
+      this->rehash(slots_.empty() ? 16 : slots_.size() * 2);
+    slot& s = slots_[this->probe(str)];
+    if (!s.data) {
+      s.data = this->copy(str.view());
+      s.size = str.size();
+      s.hash = str.hash();
+      ++size_;
+    }
+    return view_type{s.data, s.size, safederef};
+  }
+
+  // Returns the interned copy of `str`, or a null view if it is not in the
+  // set.
+  view_type
+  find(view_type str) const noexcept
+  { return this->find(hashed_type{str}); }
+
+  view_type
+  find(const hashed_type& str) const noexcept
+  {
+    if (slots_.empty())
+      return view_type{};
+    const slot& s = slots_[this->probe(str)];
+    return s.data ? view_type{s.data, s.size, safederef} : view_type{};
+  }
+
+  bool
+  contains(view_type str) const noexcept
+  { return this->find(str).data() != nullptr; }
+
+  // The number of distinct strings.
+  size_type
+  size() const noexcept
+  { return size_; }
+
+  [[nodiscard]] bool
+  empty() const noexcept
+  { return size_ == 0; }
+
+  // The number of bytes allocated for the strings and the table.
+  size_type
+  memory_usage() const noexcept
+  { return arena_bytes_ + slots_.size() * sizeof(slot); }
+
+  // Prepares the table for `n` strings without rehashing.
+  void
+  reserve(size_type n)
+  {
+    size_type capacity = 16;
+    while (n * 4 > capacity * 3)
+      capacity *= 2;
+    if (capacity > slots_.size())
+      this->rehash(capacity);
+  }
+
+  // Removes all strings, which invalidates the interned views.
+  void
+  clear() noexcept
+  {
+    slots_.clear();
+    blocks_.clear();
+    size_ = 0;
+    next_ = nullptr;
+    remaining_ = 0;
+    arena_bytes_ = 0;
+  }
+
+private:
+  struct slot
+  {
+    const char* data = nullptr;
+    size_type size = 0;
+    uint64_t hash = 0;
+  };
+
+  // Returns the index of the slot of `str`, or of the free slot where it
+  // would be inserted. The table is never full, so probing always ends.
+  size_type
+  probe(const hashed_type& str) const noexcept
+  {
+    const size_type mask = slots_.size() - 1;
+    for (size_type i = static_cast<size_type>(str.hash()) & mask;;
+         i = (i + 1) & mask) {
+      const slot& s = slots_[i];
+      if (!s.data || (s.hash == str.hash()
+                      && view_type(s.data, s.size) == str.view()))
+        return i;
+    }
+  }
+
+  void
+  rehash(size_type capacity)
+  {
+    std::vector<slot> old(capacity);
+    old.swap(slots_);
+    const size_type mask = capacity - 1;
+    for (const slot& s : old) {
+      if (!s.data)
+        continue;
+      size_type i = static_cast<size_type>(s.hash) & mask;
+      while (slots_[i].data)
+        i = (i + 1) & mask;
+      slots_[i] = s;
+    }
+  }
+
+  // Copies `str` with a null character into the arena.
+  const char*
+  copy(view_type str)
+  {
+    const size_type n = str.size() + 1;
+    char* dst;
+    if (n <= remaining_) {
+      dst = next_;
+      next_ += n;
+      remaining_ -= n;
+    } else if (n > block_size_ / 4) {
+      dst = this->allocate(n);
+    } else {
+      dst = this->allocate(block_size_);
+      next_ = dst + n;
+      remaining_ = block_size_ - n;
+    }
+    view_type::traits_type::copy(dst, str.data(), str.size());
+    dst[str.size()] = '\0';
+    return dst;
+  }
+
+  char*
+  allocate(size_type n)
+  {
+    blocks_.emplace_back(new char[n]);
+    arena_bytes_ += n;
+    return blocks_.back().get();
+  }
+
+  std::vector<slot> slots_;
+  size_type size_ = 0;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  size_type block_size_;
+  // The unused rest of the current block.
+  char* next_ = nullptr;
+  size_type remaining_ = 0;
+  size_type arena_bytes_ = 0;
+};
+
+  /**
+   *  @brief  A string interner that can be used from multiple threads.
+   *
+   *  @tparam Algorithm  The hash algorithm, see `bev::hash`
+   *
+   *  The strings are distributed over a number of shards by the upper bits
+   *  of their hash, each of them a `basic_string_interner` with its own
+   *  mutex, so that threads interning different strings rarely wait for
+   *  each other.
+   */
+template<typename Algorithm = default_hash_algorithm>
+class basic_concurrent_string_interner
+{
+public:
+  using interner_type = basic_string_interner<Algorithm>;
+  using view_type     = typename interner_type::view_type;
+  using hashed_type   = typename interner_type::hashed_type;
+  using size_type     = size_t;
+
+  static constexpr size_type default_shard_count = 16;
+
+  // The number of shards is rounded up to a power of two.
+  explicit
+  basic_concurrent_string_interner(
+      size_type shards = default_shard_count,
+      size_type block_size = interner_type::default_block_size)
+  {
+    while (shard_count_ < shards && shard_count_ < (size_type(1) << 16)) {
+      ++shard_bits_;
+      shard_count_ *= 2;
+    }
+    shards_.reset(new shard[shard_count_]);
+    for (size_type i = 0; i < shard_count_; ++i)
+      shards_[i].interner = interner_type{block_size};
+  }
+
+  view_type
+  intern(view_type str)
+  { return this->intern(hashed_type{str}); }
+
+  view_type
+  intern(const hashed_type& str)
+  {
+    shard& s = this->shard_of(str);
+    const std::lock_guard<std::mutex> lock{s.mutex};
+    return s.interner.intern(str);
+  }
+
+  view_type
+  find(view_type str) const
+  { return this->find(hashed_type{str}); }
+
+  view_type
+  find(const hashed_type& str) const
+  {
+    shard& s = this->shard_of(str);
+    const std::lock_guard<std::mutex> lock{s.mutex};
+    return s.interner.find(str);
+  }
+
+  bool
+  contains(view_type str) const
+  { return this->find(str).data() != nullptr; }
+
+  size_type
+  shard_count() const noexcept
+  { return shard_count_; }
+
+  // The number of distinct strings, which is only exact if no other thread
+  // is interning strings at the same time.
+  size_type
+  size() const
+  {
+    size_type result = 0;
+    for (size_type i = 0; i < shard_count_; ++i) {
+      const std::lock_guard<std::mutex> lock{shards_[i].mutex};
+      result += shards_[i].interner.size();
+    }
+    return result;
+  }
+
+private:
+  // On separate cache lines, so that the mutexes of the shards don't
+  // contend with each other.
+  struct alignas(64) shard
+  {
+    mutable std::mutex mutex;
+    interner_type interner;
+  };
+
+  // The interners index their tables with the lower bits of the hash.
+  shard&
+  shard_of(const hashed_type& str) const noexcept
+  {
+    return shards_[shard_bits_ ? static_cast<size_type>(
+        str.hash() >> (64 - shard_bits_)) : 0];
+  }
+
+  size_type shard_count_ = 1;
+  unsigned shard_bits_ = 0;
+  std::unique_ptr<shard[]> shards_;
+};
+
+using string_interner = basic_string_interner<>;
+using concurrent_string_interner = basic_concurrent_string_interner<>;
+
+} // namespace bev
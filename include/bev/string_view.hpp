@@ -12,11 +12,37 @@
 //    Note that this function is conservative in the sense that it may return
 //    `false` even if `.data()` would be null-terminated, for example in the
 //    presence of embedded null bytes.
+//  * A new member function `basic_string_view::c_str_or_copy()` and a new
+//    class template `bev::basic_cstring_arg` that provide a null-terminated
+//    version of the view, copying the data only if `is_cstring()` is false.
+//  * A new class `bev::char_set` that holds a precomputed set of characters,
+//    and overloads of the `find_*_of` family of member functions taking it.
+//  * An overload of `find()` taking a `bev::basic_searcher` with a
+//    precomputed needle, see `bev/searcher.hpp`.
+//  * A new functor `bev::hash<Algorithm>` that hashes views with a specific
+//    algorithm, `bev::wyhash` (the default) or `bev::murmur2`.
 //  * A new constructor from `std::string` was added, since it is not possible
 //    to replicate the original string_view interface of adding new user-defined
 //    conversions to std::string.
 //  * For the same reasons, the string_view literal operators have been renamed
-//    to `_sv` and dont live in namespace `std` anymore.
+//    to `_sv` and dont live in namespace `std` anymore. They set the
+//    safederef flag, since a literal is always null-terminated.
+//  * A new constructor taking the tag `bev::safederef` that sets the
+//    safederef flag for a pointer and length pair.
+//  * Views with the same character type but different traits, like
+//    `bev::string_view` and the case-insensitive `bev::ci_string_view` from
+//    `bev/ci_string_view.hpp`, convert implicitly into each other.
+//  * New member functions `take()`, `drop()`, `split_at()`, `ltrim()`,
+//    `rtrim()` and `trim()` for slicing views. Like `substr()` and
+//    `remove_suffix()`, they set the safederef flag when the result ends
+//    before the end of the original view.
+//  * `operator<<` writes the characters of the view without a trailing null
+//    character, and respects the width and fill of the stream. The new
+//    `bev::append_to()` appends a view to a `std::string`, and
+//    `bev/fmt.hpp` makes views formattable with {fmt}.
+//  * With `BEV_STRING_VIEW_STATS` defined, `is_cstring()`, the copies of
+//    `basic_cstring_arg`, the searches and the hashes update the counters of
+//    `bev/stats.hpp`.
 // 
 // Internal Changes:
 //  * General reformatting required by moving the class out of the `std` namespace,
@@ -25,21 +51,63 @@
 //  * Removal of all libstdc++ internal functions. This means that the class can
 //    be compiled against any standard library. In particular this includes many
 //    debug assertions and checks.
-//  * Only supports 64-bit size_t (the main reason being that I only copied the
-//    64-bit version of MurmurHash3, and I don't have a 32 bit system for
-//    testing available)
+//  * The hash is computed with 64-bit arithmetic on all platforms, and uses
+//    wyhash instead of Murmur by default.
 //  * Removed support for char8_t (since my compiler doesnt have it yet)
+//  * For `char` views with the default traits, the search functions use the
+//    vectorized kernels from `bev/detail/simd.hpp` outside of constant
+//    evaluation.
+//  * `operator==` and `operator!=` use a dedicated equality check instead of
+//    the three-way `compare()`, which for `char` views uses overlapping wide
+//    loads for short strings and the vectorized kernels for long ones.
 
 #pragma once
 
 #include <type_traits>
 #include <iosfwd>
+#include <array>
 #include <climits>
+#include <cstdint>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <utility>
+
+#include <bev/detail/simd.hpp>
+#include <bev/stats.hpp>
 
 namespace bev {
 
+// Size of the inline buffer used by `basic_cstring_arg` when the view needs
+// to be copied. Longer strings are copied to the heap instead.
+#if defined(PATH_MAX)
+inline constexpr size_t default_cstring_buffer_size = PATH_MAX;
+#else
+inline constexpr size_t default_cstring_buffer_size = 4096;
+#endif
+
+template<typename CharT, typename Traits, size_t BufferSize>
+class basic_cstring_arg;
+
+class char_set;
+
+template<typename CharT, typename Traits = std::char_traits<CharT>>
+class basic_searcher;
+
+template<typename CharT, typename Traits>
+class basic_split_range;
+
+template<typename CharT, typename Traits>
+class basic_cached_string_view;
+
+template<typename CharT, typename Traits>
+class basic_offset_view;
+
+// Tag type for the constructor of `basic_string_view` that sets the
+// safederef flag for a pointer and length pair.
+struct safederef_t { explicit safederef_t() = default; };
+inline constexpr safederef_t safederef{};
+
   /**
    *  @brief  A non-owning reference to a string.
    *
@@ -63,9 +131,9 @@ class basic_string_view
 
   // bitmask for accessing the `safederef` flag bit in `len_`.
   static const size_t safederef_flag_mask = 1ull << (CHAR_BIT*sizeof(size_t)-1);
-  static size_t set_safederef_bit(size_t x) { return x | safederef_flag_mask; }
-  static size_t clear_safederef_bit(size_t x) { return x & ~safederef_flag_mask; }
-  static bool test_safederef_bit(size_t x) { return x & safederef_flag_mask; }
+  static constexpr size_t set_safederef_bit(size_t x) { return x | safederef_flag_mask; }
+  static constexpr size_t clear_safederef_bit(size_t x) { return x & ~safederef_flag_mask; }
+  static constexpr bool test_safederef_bit(size_t x) { return x & safederef_flag_mask; }
 
 public:
 
@@ -107,29 +175,82 @@ public:
   operator=(const basic_string_view&) noexcept = default;
 
   // non-standard constructors
-  basic_string_view(const std::basic_string<CharT, Traits>& s)
+  template<typename StringTraits>
+  basic_string_view(const std::basic_string<CharT, StringTraits>& s)
     : len_{set_safederef_bit(s.size())}, str_{s.data()}
   {}
 
-  basic_string_view(std::basic_string<CharT, Traits>&&) = delete;
+  template<typename StringTraits>
+  basic_string_view(std::basic_string<CharT, StringTraits>&&) = delete;
+
+  // Views of the same characters with other traits, e.g. between
+  // `bev::string_view` and `bev::ci_string_view`, convert into each other
+  // with the safederef flag preserved.
+  template<typename OtherTraits, typename = std::enable_if_t<
+      !std::is_same_v<OtherTraits, Traits>>>
+  constexpr
+  basic_string_view(basic_string_view<CharT, OtherTraits> sv) noexcept
+    : len_{sv.len_}, str_{sv.str_}
+  { }
+
+  // Creates a view of the `len` characters at `str` with the safederef flag
+  // set. The caller guarantees that `str[len]` can be dereferenced, e.g.
+  // because the characters are followed by a null terminator.
+  constexpr
+  basic_string_view(const CharT* str, size_type len, safederef_t) noexcept
+    : basic_string_view{str, len, can_test_safederef{}}
+  { }
 
 private:
   struct can_test_safederef {};
 
-  basic_string_view(const CharT* str, size_type len, can_test_safederef)
+  constexpr
+  basic_string_view(const CharT* str, size_type len, can_test_safederef) noexcept
     : len_(set_safederef_bit(len)), str_(str)
   {}
 
+  // Read the safederef flag of views they are created from.
+  template<typename, typename>
+  friend class basic_cached_string_view;
+
+  template<typename, typename>
+  friend class basic_offset_view;
+
+  template<typename, typename>
+  friend class basic_string_view;
+
 public:
 
   // non-standard interface
-  bool is_cstring()
+  bool is_cstring() const
   {
-    if (test_safederef_bit(len_))
-      return str_[this->length()] == CharT{0};
-    return false;
+    if (!test_safederef_bit(len_)) {
+      BEV_STRING_VIEW_COUNT(is_cstring_no_flag, 1);
+      return false;
+    }
+    const bool result = str_[this->length()] == CharT{0};
+    BEV_STRING_VIEW_COUNT(is_cstring_true, result);
+    BEV_STRING_VIEW_COUNT(is_cstring_not_null, !result);
+    return result;
   }
 
+  // Returns an object holding a null-terminated version of this view: Either
+  // the original pointer if `is_cstring()` is true, or a copy stored in an
+  // inline buffer of `BufferSize` characters (or on the heap if the view
+  // doesn't fit). The result must not outlive the full-expression, e.g.
+  //
+  //     ::open(sv.c_str_or_copy().c_str(), flags);
+  template<size_t BufferSize = default_cstring_buffer_size>
+  basic_cstring_arg<CharT, Traits, BufferSize>
+  c_str_or_copy() const
+  { return basic_cstring_arg<CharT, Traits, BufferSize>{*this}; }
+
+  // Same as above, but copies into the caller-provided buffer `buf` of
+  // `size` characters instead of an inline buffer.
+  basic_cstring_arg<CharT, Traits, 0>
+  c_str_or_copy(CharT* buf, size_type size) const
+  { return basic_cstring_arg<CharT, Traits, 0>{*this, buf, size}; }
+
   // [string.view.iterators], iterator support
 
   constexpr const_iterator
@@ -223,12 +344,14 @@ public:
   remove_prefix(size_type n) noexcept
   {
     this->str_ += n;
-    this->length() -= n;
+    this->len_ -= n;
   }
 
+  // The character after the shortened view is inside of this one, so the
+  // result has the safederef flag set unless `n` is zero.
   constexpr void
   remove_suffix(size_type n) noexcept
-  { this->length() -= n; }
+  { this->len_ = (this->len_ - n) | (n ? safederef_flag_mask : 0); }
 
   constexpr void
   swap(basic_string_view& sv) noexcept
@@ -250,15 +373,74 @@ public:
     return rlen;
   }
 
+  // Keeps the safederef flag, and sets it if the substring ends before the
+  // end of this view.
   constexpr basic_string_view
   substr(size_type pos = 0, size_type n = npos) const noexcept(false)
   {
     const size_type rlen = std::min(n, this->length() - pos);
-    if (test_safederef_bit(len_))
+    if (test_safederef_bit(len_) || rlen < this->length() - pos)
       return basic_string_view{str_ + pos, rlen, can_test_safederef{}};
     return basic_string_view{str_ + pos, rlen};
   }
 
+  // non-standard slicing operations, which set the safederef flag as
+  // `substr()` does.
+
+  // The first `n` characters, or the whole view if it is shorter.
+  constexpr basic_string_view
+  take(size_type n) const noexcept
+  { return this->substr(0, n); }
+
+  // All but the first `n` characters, or an empty view at the end if it is
+  // shorter.
+  constexpr basic_string_view
+  drop(size_type n) const noexcept
+  { return this->substr(std::min(n, this->length())); }
+
+  // The views before and from `pos`, which is clamped to `size()`.
+  constexpr std::pair<basic_string_view, basic_string_view>
+  split_at(size_type pos) const noexcept
+  {
+    pos = std::min(pos, this->length());
+    return {this->substr(0, pos), this->substr(pos)};
+  }
+
+  // Remove the leading, trailing or both leading and trailing characters
+  // that are whitespace (` \t\n\v\f\r`), or in `chars` or `set`.
+
+  constexpr basic_string_view
+  ltrim() const noexcept;
+
+  constexpr basic_string_view
+  ltrim(basic_string_view chars) const noexcept
+  { return this->drop(this->find_first_not_of(chars)); }
+
+  constexpr basic_string_view
+  ltrim(const char_set& set) const noexcept;
+
+  constexpr basic_string_view
+  rtrim() const noexcept;
+
+  constexpr basic_string_view
+  rtrim(basic_string_view chars) const noexcept
+  { return this->take(this->find_last_not_of(chars) + 1); }
+
+  constexpr basic_string_view
+  rtrim(const char_set& set) const noexcept;
+
+  constexpr basic_string_view
+  trim() const noexcept
+  { return this->ltrim().rtrim(); }
+
+  constexpr basic_string_view
+  trim(basic_string_view chars) const noexcept
+  { return this->ltrim(chars).rtrim(chars); }
+
+  constexpr basic_string_view
+  trim(const char_set& set) const noexcept
+  { return this->ltrim(set).rtrim(set); }
+
   constexpr int
   compare(basic_string_view str) const noexcept
   {
@@ -312,7 +494,7 @@ public:
   ends_with(basic_string_view x) const noexcept
   {
     return this->size() >= x.size()
-        && this->compare(this->size() - x.size(), npos, x) == 0;
+        && this->substr(this->size() - x.size()) == x;
   }
 
   constexpr bool
@@ -339,6 +521,12 @@ public:
   find(const CharT* str, size_type pos = 0) const noexcept
   { return this->find(str, pos, traits_type::length(str)); }
 
+  // Finds the needle of a precomputed searcher, see `bev/searcher.hpp`.
+  size_type
+  find(const basic_searcher<CharT, Traits>& searcher,
+       size_type pos = 0) const noexcept
+  { return searcher.find_in(*this, pos); }
+
   constexpr size_type
   rfind(basic_string_view str, size_type pos = npos) const noexcept
   { return this->rfind(str.str_, pos, str.length()); }
@@ -369,6 +557,10 @@ public:
   find_first_of(const CharT* str, size_type pos = 0) const noexcept
   { return this->find_first_of(str, pos, traits_type::length(str)); }
 
+  constexpr size_type
+  find_first_of(const char_set& set, size_type pos = 0) const noexcept
+  { return this->find_first_in_set<false>(set, pos); }
+
   constexpr size_type
   find_last_of(basic_string_view str,
                size_type pos = npos) const noexcept
@@ -386,6 +578,10 @@ public:
   find_last_of(const CharT* str, size_type pos = npos) const noexcept
   { return this->find_last_of(str, pos, traits_type::length(str)); }
 
+  constexpr size_type
+  find_last_of(const char_set& set, size_type pos = npos) const noexcept
+  { return this->find_last_in_set<false>(set, pos); }
+
   constexpr size_type
   find_first_not_of(basic_string_view str,
                     size_type pos = 0) const noexcept
@@ -405,6 +601,10 @@ public:
                                    traits_type::length(str));
   }
 
+  constexpr size_type
+  find_first_not_of(const char_set& set, size_type pos = 0) const noexcept
+  { return this->find_first_in_set<true>(set, pos); }
+
   constexpr size_type
   find_last_not_of(basic_string_view str,
                    size_type pos = npos) const noexcept
@@ -425,8 +625,22 @@ public:
                                   traits_type::length(str));
   }
 
+  constexpr size_type
+  find_last_not_of(const char_set& set, size_type pos = npos) const noexcept
+  { return this->find_last_in_set<true>(set, pos); }
+
 private:
 
+  // Shared implementation of the `char_set` overloads of the `find_*_of`
+  // family, `Negate` selects the `_not_of` variants.
+  template<bool Negate>
+  constexpr size_type
+  find_first_in_set(const char_set& set, size_type pos) const noexcept;
+
+  template<bool Negate>
+  constexpr size_type
+  find_last_in_set(const char_set& set, size_type pos) const noexcept;
+
   // Return the difference between n1 and n2, clamped to the range of int.
   static constexpr int
   s_compare(size_type n1, size_type n2) noexcept
@@ -451,25 +665,39 @@ namespace detail {
 // argument gets implicitly converted to the deduced type. See n3766.html.
 template<typename Tp>
 using identity = std::common_type_t<Tp>;
+
+// Equality of two views of the same size. Unlike `compare()` this doesn't
+// need to find the first difference, so for `char` it can use wide loads.
+template<typename CharT, typename Traits>
+constexpr bool
+equal_(basic_string_view<CharT, Traits> x,
+       basic_string_view<CharT, Traits> y) noexcept
+{
+  if constexpr (has_kernels_v<CharT, Traits>) {
+    if (!BEV_STRING_VIEW_IS_CONSTANT_EVALUATED())
+      return equal_kernel(x.data(), y.data(), x.size());
+  }
+  return Traits::compare(x.data(), y.data(), x.size()) == 0;
+}
 } // namespace detail
 
 template<typename CharT, typename Traits>
 constexpr bool
 operator==(basic_string_view<CharT, Traits> x,
            basic_string_view<CharT, Traits> y) noexcept
-{ return x.size() == y.size() && x.compare(y) == 0; }
+{ return x.size() == y.size() && detail::equal_(x, y); }
 
 template<typename CharT, typename Traits>
 constexpr bool
 operator==(basic_string_view<CharT, Traits> x,
            detail::identity<basic_string_view<CharT, Traits>> y) noexcept
-{ return x.size() == y.size() && x.compare(y) == 0; }
+{ return x.size() == y.size() && detail::equal_(x, y); }
 
 template<typename CharT, typename Traits>
 constexpr bool
 operator==(detail::identity<basic_string_view<CharT, Traits>> x,
            basic_string_view<CharT, Traits> y) noexcept
-{ return x.size() == y.size() && x.compare(y) == 0; }
+{ return x.size() == y.size() && detail::equal_(x, y); }
 
 template<typename CharT, typename Traits>
 constexpr bool
@@ -562,18 +790,195 @@ operator>=(detail::identity<basic_string_view<CharT, Traits>> x,
 { return x.compare(y) >= 0; }
 
 // [string.view.io], Inserters and extractors
+
+namespace detail {
+
+template<typename CharT, typename Traits>
+bool
+ostream_fill_(std::basic_ostream<CharT, Traits>& os, size_t n)
+{
+  const CharT c = os.fill();
+  for (; n > 0; --n)
+    if (Traits::eq_int_type(os.rdbuf()->sputc(c), Traits::eof()))
+      return false;
+  return true;
+}
+
+} // namespace detail
+
+// Writes the characters with a single `sputn()`, padded with the fill
+// character to `os.width()` as for `std::basic_string`.
 template<typename CharT, typename Traits>
 inline std::basic_ostream<CharT, Traits>&
 operator<<(std::basic_ostream<CharT, Traits>& os,
            basic_string_view<CharT,Traits> str)
 {
-  auto len = str.length();
-  for (size_t i=0; i<str.length(); ++i) {
-    os << str.str_[i];
-  }
-  return os << CharT{0};
+  using ostream_type = std::basic_ostream<CharT, Traits>;
+  const typename ostream_type::sentry sentry{os};
+  if (!sentry)
+    return os;
+  // `std::streamsize`, which `<iosfwd>` doesn't declare.
+  using streamsize = decltype(os.width());
+  const auto size = static_cast<streamsize>(str.size());
+  const streamsize width = os.width();
+  const size_t padding = width > size ? static_cast<size_t>(width - size) : 0;
+  const bool left = (os.flags() & ostream_type::adjustfield)
+                 == ostream_type::left;
+  bool ok = left || detail::ostream_fill_(os, padding);
+  ok = ok && os.rdbuf()->sputn(str.data(), size) == size;
+  ok = ok && (!left || detail::ostream_fill_(os, padding));
+  os.width(0);
+  if (!ok)
+    os.setstate(ostream_type::badbit);
+  return os;
 }
 
+// Appends the characters of `str` to `s` with a single copy, also for views
+// with other traits than `s`.
+template<typename CharT, typename StringTraits, typename Allocator,
+         typename Traits>
+inline std::basic_string<CharT, StringTraits, Allocator>&
+append_to(std::basic_string<CharT, StringTraits, Allocator>& s,
+          basic_string_view<CharT, Traits> str)
+{ return s.append(str.data(), str.size()); }
+
+// [cstring.arg], null-terminated function arguments
+
+  /**
+   *  @brief  A null-terminated version of a basic_string_view.
+   *
+   *  @tparam CharT       Type of character
+   *  @tparam Traits      Traits for character type
+   *  @tparam BufferSize  Number of characters in the inline buffer
+   *
+   *  Holds the original pointer of the view if it is a c-string, otherwise
+   *  a null-terminated copy of the view. The copy is placed in the inline
+   *  buffer or the caller-provided buffer if the view plus the null byte
+   *  fits, and on the heap otherwise.
+   */
+template<typename CharT, typename Traits = std::char_traits<CharT>,
+         size_t BufferSize = default_cstring_buffer_size>
+class basic_cstring_arg
+{
+public:
+  explicit
+  basic_cstring_arg(basic_string_view<CharT, Traits> sv)
+  { init(sv, buffer_.data(), BufferSize); }
+
+  basic_cstring_arg(basic_string_view<CharT, Traits> sv,
+                    CharT* buf, size_t size)
+  { init(sv, buf, size); }
+
+  // The result of `c_str()` may point into this object.
+  basic_cstring_arg(const basic_cstring_arg&) = delete;
+  basic_cstring_arg& operator=(const basic_cstring_arg&) = delete;
+
+  const CharT*
+  c_str() const noexcept
+  { return str_; }
+
+  // Returns true if `c_str()` points to a copy of the original view.
+  bool
+  copied() const noexcept
+  { return copied_; }
+
+  // Returns true if the copy had to be placed on the heap.
+  bool
+  heap_allocated() const noexcept
+  { return heap_ != nullptr; }
+
+private:
+  void
+  init(basic_string_view<CharT, Traits> sv, CharT* buf, size_t size)
+  {
+    if (sv.is_cstring()) {
+      str_ = sv.data();
+      return;
+    }
+    const size_t len = sv.length();
+    CharT* dst = buf;
+    if (len >= size) {
+      heap_.reset(new CharT[len + 1]);
+      dst = heap_.get();
+      BEV_STRING_VIEW_COUNT(cstring_heap_copies, 1);
+    }
+    BEV_STRING_VIEW_COUNT(cstring_copies, 1);
+    BEV_STRING_VIEW_COUNT(cstring_copy_bytes, len * sizeof(CharT));
+    Traits::copy(dst, sv.data(), len);
+    Traits::assign(dst[len], CharT{0});
+    str_ = dst;
+    copied_ = true;
+  }
+
+  const CharT* str_;
+  bool copied_ = false;
+  std::unique_ptr<CharT[]> heap_;
+  std::array<CharT, BufferSize> buffer_;
+};
+
+using cstring_arg = basic_cstring_arg<char>;
+using wcstring_arg = basic_cstring_arg<wchar_t>;
+using u16cstring_arg = basic_cstring_arg<char16_t>;
+using u32cstring_arg = basic_cstring_arg<char32_t>;
+
+// [char.set], precomputed character sets
+
+  /**
+   *  @brief  A set of characters for the `find_*_of` family of functions.
+   *
+   *  The overloads of `find_first_of()`, `find_last_of()`,
+   *  `find_first_not_of()` and `find_last_not_of()` taking a character
+   *  string build a `char_set` on every call. Creating it once up front
+   *  avoids that when searching for the same set repeatedly:
+   *
+   *  @code
+   *    static constexpr bev::char_set delims{" \t\r\n,;:"};
+   *    auto pos = line.find_first_of(delims);
+   *  @endcode
+   *
+   *  Can only be used with `char` views using the default traits.
+   */
+class char_set
+{
+public:
+  constexpr
+  char_set() noexcept = default;
+
+  constexpr explicit
+  char_set(const char* chars, size_t n) noexcept
+    : class_{detail::make_byte_class(chars, n)}
+  { }
+
+  constexpr explicit
+  char_set(basic_string_view<char> chars) noexcept
+    : char_set{chars.data(), chars.size()}
+  { }
+
+  constexpr bool
+  contains(char c) const noexcept
+  { return class_.contains(c); }
+
+private:
+  template<typename CharT, typename Traits>
+  friend class basic_string_view;
+
+  template<typename CharT, typename Traits>
+  friend class basic_split_range;
+
+  detail::byte_class class_;
+};
+
+namespace detail {
+
+// The characters removed by `trim()`, as in the "C" locale.
+template<typename CharT>
+inline constexpr CharT whitespace_chars[] = {
+  CharT(' '), CharT('\t'), CharT('\n'), CharT('\v'), CharT('\f'), CharT('\r')};
+
+inline constexpr char_set whitespace_set{whitespace_chars<char>, 6};
+
+} // namespace detail
+
 // basic_string_view typedef names
 using string_view = basic_string_view<char>;
 using wstring_view = basic_string_view<wchar_t>;
@@ -584,19 +989,19 @@ using u32string_view = basic_string_view<char32_t>;
 
 inline constexpr basic_string_view<char>
 operator""_sv(const char* str, size_t len) noexcept
-{ return basic_string_view<char>{str, len}; }
+{ return basic_string_view<char>{str, len, safederef}; }
 
 inline constexpr basic_string_view<wchar_t>
 operator""_sv(const wchar_t* str, size_t len) noexcept
-{ return basic_string_view<wchar_t>{str, len}; }
+{ return basic_string_view<wchar_t>{str, len, safederef}; }
 
 inline constexpr basic_string_view<char16_t>
 operator""_sv(const char16_t* str, size_t len) noexcept
-{ return basic_string_view<char16_t>{str, len}; }
+{ return basic_string_view<char16_t>{str, len, safederef}; }
 
 inline constexpr basic_string_view<char32_t>
 operator""_sv(const char32_t* str, size_t len) noexcept
-{ return basic_string_view<char32_t>{str, len}; }
+{ return basic_string_view<char32_t>{str, len, safederef}; }
 
 
 // Implementation
@@ -606,15 +1011,35 @@ constexpr typename basic_string_view<CharT, Traits>::size_type
 basic_string_view<CharT, Traits>::
 find(const CharT* str, size_type pos, size_type n) const noexcept
 {
+  if constexpr (detail::is_default_char_v<CharT, Traits>)
+    BEV_STRING_VIEW_COUNT_CALL(find, pos < length() ? length() - pos : 0);
   if (n == 0)
     return pos <= length() ? pos : npos;
 
+  if constexpr (detail::has_kernels_v<CharT, Traits>) {
+    if (!BEV_STRING_VIEW_IS_CONSTANT_EVALUATED()) {
+      if (n > length() || pos > length() - n)
+        return npos;
+      const size_type ret = detail::find_kernel(this->str_ + pos,
+                                                length() - pos, str, n);
+      return ret == detail::kernel_npos ? npos : pos + ret;
+    }
+  }
+
+  // Candidates for the first character are found with `traits_type::find()`,
+  // which is vectorized for some traits.
   if (n <= length()) {
-    for (; pos <= length() - n; ++pos)
-      if (traits_type::eq(this->str_[pos], str[0])
-          && traits_type::compare(this->str_ + pos + 1,
-                                  str + 1, n - 1) == 0)
+    const size_type last = length() - n;
+    while (pos <= last) {
+      const CharT* p = traits_type::find(this->str_ + pos, last - pos + 1,
+                                         str[0]);
+      if (!p)
+        break;
+      pos = p - this->str_;
+      if (traits_type::compare(p + 1, str + 1, n - 1) == 0)
         return pos;
+      ++pos;
+    }
   }
   return npos;
 }
@@ -624,6 +1049,8 @@ constexpr typename basic_string_view<CharT, Traits>::size_type
 basic_string_view<CharT, Traits>::find(
   CharT c, size_type pos) const noexcept
 {
+  if constexpr (detail::is_default_char_v<CharT, Traits>)
+    BEV_STRING_VIEW_COUNT_CALL(find_char, pos < length() ? length() - pos : 0);
   size_type ret = npos;
   if (pos < length())
     {
@@ -640,6 +1067,18 @@ constexpr typename basic_string_view<CharT, Traits>::size_type
 basic_string_view<CharT, Traits>::
 rfind(const CharT* str, size_type pos, size_type n) const noexcept
 {
+  if constexpr (detail::is_default_char_v<CharT, Traits>)
+    BEV_STRING_VIEW_COUNT_CALL(rfind, std::min(pos, length()));
+  if constexpr (detail::has_kernels_v<CharT, Traits>) {
+    if (!BEV_STRING_VIEW_IS_CONSTANT_EVALUATED() && n > 0) {
+      if (n > length())
+        return npos;
+      const size_type end = std::min(size_type(length() - n), pos) + n;
+      const size_type ret = detail::rfind_kernel(this->str_, end, str, n);
+      return ret == detail::kernel_npos ? npos : ret;
+    }
+  }
+
   if (n <= length()) {
     pos = std::min(size_type(length() - n), pos);
     do {
@@ -655,6 +1094,18 @@ constexpr typename basic_string_view<CharT, Traits>::size_type
 basic_string_view<CharT, Traits>::
 rfind(CharT c, size_type pos) const noexcept
 {
+  if constexpr (detail::is_default_char_v<CharT, Traits>)
+    BEV_STRING_VIEW_COUNT_CALL(rfind_char, std::min(pos, length()));
+  if constexpr (detail::has_kernels_v<CharT, Traits>) {
+    if (!BEV_STRING_VIEW_IS_CONSTANT_EVALUATED()) {
+      if (empty())
+        return npos;
+      const size_type n = std::min(pos, size_type(length() - 1)) + 1;
+      const size_type ret = detail::rfind_kernel(this->str_, n, c);
+      return ret == detail::kernel_npos ? npos : ret;
+    }
+  }
+
   size_type size = length();
   if (size > 0) {
     if (--size > pos)
@@ -672,6 +1123,12 @@ basic_string_view<CharT, Traits>::
 find_first_of(const CharT* str, size_type pos,
               size_type n) const noexcept
 {
+  if constexpr (detail::is_default_char_v<CharT, Traits>) {
+    if (n == 1)
+      return this->find(str[0], pos);
+    return this->find_first_of(char_set{str, n}, pos);
+  }
+
   for (; n && pos < length(); ++pos) {
     const CharT* p = traits_type::find(str, n,
                                        this->str_[pos]);
@@ -687,6 +1144,12 @@ basic_string_view<CharT, Traits>::
 find_last_of(const CharT* str, size_type pos,
              size_type n) const noexcept
 {
+  if constexpr (detail::is_default_char_v<CharT, Traits>) {
+    if (n == 1)
+      return this->rfind(str[0], pos);
+    return this->find_last_of(char_set{str, n}, pos);
+  }
+
   size_type size = this->size();
   if (size && n)
     {
@@ -707,6 +1170,12 @@ constexpr typename basic_string_view<CharT, Traits>::size_type
 basic_string_view<CharT, Traits>::find_first_not_of(
   const CharT* str, size_type pos, size_type n) const noexcept
 {
+  if constexpr (detail::is_default_char_v<CharT, Traits>) {
+    if (n == 1)
+      return this->find_first_not_of(str[0], pos);
+    return this->find_first_not_of(char_set{str, n}, pos);
+  }
+
   for (; pos < length(); ++pos)
     if (!traits_type::find(str, n, this->str_[pos]))
       return pos;
@@ -731,6 +1200,12 @@ basic_string_view<CharT, Traits>::find_last_not_of(
     size_type pos,
     size_type n) const noexcept
 {
+  if constexpr (detail::is_default_char_v<CharT, Traits>) {
+    if (n == 1)
+      return this->find_last_not_of(str[0], pos);
+    return this->find_last_not_of(char_set{str, n}, pos);
+  }
+
   size_type size = length();
   if (size) {
       if (--size > pos)
@@ -760,20 +1235,128 @@ basic_string_view<CharT, Traits>::find_last_not_of(CharT c, size_type pos) const
   return npos;
 }
 
+template<typename CharT, typename Traits>
+template<bool Negate>
+constexpr typename basic_string_view<CharT, Traits>::size_type
+basic_string_view<CharT, Traits>::find_first_in_set(
+  const char_set& set, size_type pos) const noexcept
+{
+  static_assert(detail::is_default_char_v<CharT, Traits>,
+                "bev::char_set can only be used with bev::string_view");
+  BEV_STRING_VIEW_COUNT_CALL(find_of, pos < length() ? length() - pos : 0);
+  if (pos >= length())
+    return npos;
+
+  if constexpr (detail::has_kernels_v<CharT, Traits>) {
+    if (!BEV_STRING_VIEW_IS_CONSTANT_EVALUATED()) {
+      const size_type ret = detail::find_first_of_kernel<Negate>(
+          this->str_ + pos, length() - pos, set.class_);
+      return ret == detail::kernel_npos ? npos : pos + ret;
+    }
+  }
+  const size_type ret = detail::scalar::find_first_of<Negate>(
+      this->str_, length(), set.class_, pos);
+  return ret == detail::kernel_npos ? npos : ret;
+}
+
+template<typename CharT, typename Traits>
+template<bool Negate>
+constexpr typename basic_string_view<CharT, Traits>::size_type
+basic_string_view<CharT, Traits>::find_last_in_set(
+  const char_set& set, size_type pos) const noexcept
+{
+  static_assert(detail::is_default_char_v<CharT, Traits>,
+                "bev::char_set can only be used with bev::string_view");
+  BEV_STRING_VIEW_COUNT_CALL(find_of, std::min(pos, length()));
+  if (empty())
+    return npos;
+
+  // Number of characters to search, i.e. the ones in [0, pos].
+  const size_type n = std::min(pos, size_type(length() - 1)) + 1;
+  if constexpr (detail::has_kernels_v<CharT, Traits>) {
+    if (!BEV_STRING_VIEW_IS_CONSTANT_EVALUATED()) {
+      const size_type ret = detail::find_last_of_kernel<Negate>(
+          this->str_, n, set.class_);
+      return ret == detail::kernel_npos ? npos : ret;
+    }
+  }
+  const size_type ret = detail::scalar::find_last_of<Negate>(
+      this->str_, n, set.class_);
+  return ret == detail::kernel_npos ? npos : ret;
+}
+
+template<typename CharT, typename Traits>
+constexpr basic_string_view<CharT, Traits>
+basic_string_view<CharT, Traits>::ltrim() const noexcept
+{
+  if constexpr (detail::is_default_char_v<CharT, Traits>)
+    return this->ltrim(detail::whitespace_set);
+  else
+    return this->ltrim(basic_string_view{detail::whitespace_chars<CharT>, 6});
+}
+
+// Most views don't start or end with whitespace, so check the first or last
+// character before calling the kernel.
+template<typename CharT, typename Traits>
+constexpr basic_string_view<CharT, Traits>
+basic_string_view<CharT, Traits>::ltrim(const char_set& set) const noexcept
+{
+  if (this->empty() || !set.contains(this->front()))
+    return *this;
+  return this->drop(this->find_first_not_of(set, 1));
+}
+
+template<typename CharT, typename Traits>
+constexpr basic_string_view<CharT, Traits>
+basic_string_view<CharT, Traits>::rtrim() const noexcept
+{
+  if constexpr (detail::is_default_char_v<CharT, Traits>)
+    return this->rtrim(detail::whitespace_set);
+  else
+    return this->rtrim(basic_string_view{detail::whitespace_chars<CharT>, 6});
+}
+
+template<typename CharT, typename Traits>
+constexpr basic_string_view<CharT, Traits>
+basic_string_view<CharT, Traits>::rtrim(const char_set& set) const noexcept
+{
+  if (this->empty() || !set.contains(this->back()))
+    return *this;
+  return this->take(this->find_last_not_of(set, this->length() - 1) + 1);
+}
+
 // namespace for the implementation of the string_view hash
 namespace detail {
 
-inline std::size_t unaligned_load_(const char* p)
+// Loads `sizeof(T)` bytes as a little-endian integer. This also works during
+// constant evaluation, so hashes computed at compile time are identical to
+// the ones computed at run time.
+template<typename T>
+constexpr T load_le_(const char* p) noexcept
 {
-  std::size_t result;
-  __builtin_memcpy(&result, p, sizeof(result));
+#if defined(BEV_STRING_VIEW_IS_CONSTANT_EVALUATED)
+  if (!BEV_STRING_VIEW_IS_CONSTANT_EVALUATED()) {
+    T result = 0;
+    __builtin_memcpy(&result, p, sizeof(result));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    if constexpr (sizeof(T) == 8)
+      result = __builtin_bswap64(result);
+    else
+      result = __builtin_bswap32(result);
+#endif
+    return result;
+  }
+#endif
+  T result = 0;
+  for (size_t i = sizeof(T); i-- > 0; )
+    result = (result << 8) | static_cast<unsigned char>(p[i]);
   return result;
 }
 
 // Loads n bytes, where 1 <= n < 8.
-inline std::size_t load_bytes_(const char* p, int n)
+constexpr uint64_t load_bytes_(const char* p, int n) noexcept
 {
-  std::size_t result = 0;
+  uint64_t result = 0;
   --n;
   do
     result = (result << 8) + static_cast<unsigned char>(p[n]);
@@ -781,28 +1364,28 @@ inline std::size_t load_bytes_(const char* p, int n)
   return result;
 }
 
-inline std::size_t shift_mix_(std::size_t v)
+constexpr uint64_t shift_mix_(uint64_t v) noexcept
 { return v ^ (v >> 47);}
 
-// Implementation of Murmur hash for 64-bit size_t.
-size_t hash_bytes_(const void* ptr, size_t len, size_t seed)
+// Implementation of Murmur hash for 64-bit integers, identical to the one
+// used by libstdc++ for `std::hash<std::string_view>` on 64-bit platforms.
+constexpr uint64_t hash_bytes_(const char* buf, size_t len, uint64_t seed) noexcept
 {
-  constexpr const size_t mul = (((size_t) 0xc6a4a793UL) << 32UL)
-          + (size_t) 0x5bd1e995UL;
-  const char* const buf = static_cast<const char*>(ptr);
+  constexpr const uint64_t mul = (((uint64_t) 0xc6a4a793UL) << 32UL)
+          + (uint64_t) 0x5bd1e995UL;
 
-  // Remove the bytes not divisible by the sizeof(size_t).  This
+  // Remove the bytes not divisible by the sizeof(uint64_t).  This
   // allows the main loop to process the data as 64-bit integers.
   const size_t len_aligned = len & ~(size_t)0x7;
   const char* const end = buf + len_aligned;
-  size_t hash = seed ^ (len * mul);
+  uint64_t hash = seed ^ (len * mul);
   for (const char* p = buf; p != end; p += 8) {
-      const size_t data = shift_mix_(unaligned_load_(p) * mul) * mul;
+      const uint64_t data = shift_mix_(load_le_<uint64_t>(p) * mul) * mul;
       hash ^= data;
       hash *= mul;
   }
   if ((len & 0x7) != 0) {
-      const size_t data = load_bytes_(end, len & 0x7);
+      const uint64_t data = load_bytes_(end, len & 0x7);
       hash ^= data;
       hash *= mul;
   }
@@ -811,7 +1394,172 @@ size_t hash_bytes_(const void* ptr, size_t len, size_t seed)
   return hash;
 }
 
+// Computes the full 128-bit product of `a` and `b`, and returns the low half
+// in `a` and the high half in `b`.
+constexpr void wymum_(uint64_t& a, uint64_t& b) noexcept
+{
+#if defined(__SIZEOF_INT128__)
+  const unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+  a = static_cast<uint64_t>(r);
+  b = static_cast<uint64_t>(r >> 64);
+#else
+  const uint64_t ha = a >> 32, hb = b >> 32;
+  const uint64_t la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+  const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  const uint64_t t = rl + (rm0 << 32);
+  uint64_t carry = t < rl;
+  const uint64_t lo = t + (rm1 << 32);
+  carry += lo < t;
+  a = lo;
+  b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+constexpr uint64_t wymix_(uint64_t a, uint64_t b) noexcept
+{
+  wymum_(a, b);
+  return a ^ b;
+}
+
+// Implementation of wyhash (final version 4), see
+// https://github.com/wangyi-fudan/wyhash. Inputs of up to 16 bytes are read
+// with two possibly overlapping loads from each end instead of a loop.
+constexpr uint64_t wyhash_bytes_(const char* p, size_t len, uint64_t seed) noexcept
+{
+  constexpr uint64_t secret[4] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+    0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull};
+
+  seed ^= wymix_(seed ^ secret[0], secret[1]);
+  uint64_t a = 0;
+  uint64_t b = 0;
+  if (len <= 16) {
+    if (len >= 4) {
+      const size_t off = (len >> 3) << 2;
+      a = (uint64_t(load_le_<uint32_t>(p)) << 32)
+          | load_le_<uint32_t>(p + off);
+      b = (uint64_t(load_le_<uint32_t>(p + len - 4)) << 32)
+          | load_le_<uint32_t>(p + len - 4 - off);
+    } else if (len > 0) {
+      a = (uint64_t(static_cast<unsigned char>(p[0])) << 16)
+          | (uint64_t(static_cast<unsigned char>(p[len >> 1])) << 8)
+          | static_cast<unsigned char>(p[len - 1]);
+    }
+  } else {
+    size_t i = len;
+    if (i > 48) {
+      uint64_t see1 = seed;
+      uint64_t see2 = seed;
+      do {
+        seed = wymix_(load_le_<uint64_t>(p) ^ secret[1],
+                      load_le_<uint64_t>(p + 8) ^ seed);
+        see1 = wymix_(load_le_<uint64_t>(p + 16) ^ secret[2],
+                      load_le_<uint64_t>(p + 24) ^ see1);
+        see2 = wymix_(load_le_<uint64_t>(p + 32) ^ secret[3],
+                      load_le_<uint64_t>(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = wymix_(load_le_<uint64_t>(p) ^ secret[1],
+                    load_le_<uint64_t>(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = load_le_<uint64_t>(p + i - 16);
+    b = load_le_<uint64_t>(p + i - 8);
+  }
+  a ^= secret[1];
+  b ^= seed;
+  wymum_(a, b);
+  return wymix_(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
 } // namespace detail
+
+// [string.view.hash], hash algorithms
+
+// The Murmur-based hash used by libstdc++, which was the only hash supported
+// by earlier versions of this library.
+struct murmur2
+{
+  static constexpr uint64_t default_seed = 0xc70f6907ull;
+
+  static constexpr uint64_t
+  hash_bytes(const char* p, size_t len,
+             uint64_t seed = default_seed) noexcept
+  { return detail::hash_bytes_(p, len, seed); }
+};
+
+// wyhash, which is considerably faster than Murmur, in particular for short
+// strings.
+struct wyhash
+{
+  static constexpr uint64_t default_seed = 0;
+
+  static constexpr uint64_t
+  hash_bytes(const char* p, size_t len,
+             uint64_t seed = default_seed) noexcept
+  { return detail::wyhash_bytes_(p, len, seed); }
+};
+
+namespace detail {
+// Whether `Traits` has its own `hash_bytes<Algorithm>()`.
+template<typename Traits, typename Algorithm, typename = void>
+inline constexpr bool has_traits_hash_v = false;
+
+template<typename Traits, typename Algorithm>
+inline constexpr bool has_traits_hash_v<Traits, Algorithm, std::void_t<
+    decltype(Traits::template hash_bytes<Algorithm>(nullptr, 0))>> = true;
+} // namespace detail
+
+// The algorithm used by `std::hash<bev::basic_string_view>`. Define
+// `BEV_STRING_VIEW_MURMUR_HASH` to get the hash values of earlier versions.
+#if defined(BEV_STRING_VIEW_MURMUR_HASH)
+using default_hash_algorithm = murmur2;
+#else
+using default_hash_algorithm = wyhash;
+#endif
+
+  /**
+   *  @brief  A hash functor for basic_string_view using a specific algorithm.
+   *
+   *  @tparam Algorithm  A type with a static `hash_bytes(p, len)` function,
+   *                     e.g. `bev::wyhash` or `bev::murmur2`.
+   *
+   *  The hash value only depends on the bytes of the view, and for `char`
+   *  views it can also be computed at compile time. Traits that consider
+   *  different bytes equal provide a static `hash_bytes<Algorithm>(p, len)`
+   *  function, which is used instead, see `bev::ascii_ci_traits`.
+   */
+template<typename Algorithm = default_hash_algorithm>
+struct hash
+{
+  template<typename CharT, typename Traits>
+  constexpr size_t
+  operator()(basic_string_view<CharT, Traits> str) const noexcept
+  { return static_cast<size_t>(hash64(str)); }
+
+  // The full 64-bit hash value, which `operator()` truncates on platforms
+  // with a 32-bit `size_t`.
+  template<typename CharT, typename Traits>
+  static constexpr uint64_t
+  hash64(basic_string_view<CharT, Traits> str) noexcept
+  {
+    if constexpr (detail::is_default_char_v<CharT, Traits>)
+      BEV_STRING_VIEW_COUNT_CALL(hash, str.length());
+    if constexpr (detail::has_traits_hash_v<Traits, Algorithm>)
+      return Traits::template hash_bytes<Algorithm>(str.data(), str.length());
+    else if constexpr (std::is_same_v<CharT, char>)
+      return Algorithm::hash_bytes(str.data(), str.length());
+    else
+      return Algorithm::hash_bytes(reinterpret_cast<const char*>(str.data()),
+                                   str.length() * sizeof(CharT));
+  }
+};
+
 } // namespace bev
 
 namespace std  {
@@ -821,9 +1569,9 @@ namespace std  {
 template<typename CharT>
 struct hash<bev::basic_string_view<CharT>>
 {
-  size_t
+  constexpr size_t
   operator()(const bev::basic_string_view<CharT>& str) const noexcept
-  { return bev::detail::hash_bytes_(str.str_, str.length()*sizeof(CharT)); }
+  { return bev::hash<>{}(str); }
 };
 
 } // namespace std
@@ -0,0 +1,223 @@
+// UTF-8 validation and code-point-aware operations on views:
+//
+//     bev::string_view text = request.body();
+//     if (!bev::utf8::is_ascii(text) && !bev::utf8::validate(text))
+//       return error("invalid UTF-8");
+//     for (char32_t cp : bev::utf8::code_points(text))
+//       ...
+//     // At most 64 bytes, without cutting a character in half.
+//     log(bev::utf8::truncate_to_boundary(text, 64));
+//
+// `validate()` uses the lookup-table algorithm of Keiser and Lemire, which
+// checks 16 or 32 bytes at a time with a few byte shuffles, and skips blocks
+// of ASCII. `is_ascii()` only has to OR the bytes together, and is even
+// faster, so it is worth checking first for mostly ASCII traffic. Both use
+// the kernels from `bev/detail/simd.hpp`, and the validation falls back to
+// decoding one sequence at a time without SSSE3, AVX2 or NEON.
+//
+// Valid UTF-8 is what RFC 3629 allows: no overlong encodings, no surrogates
+// and nothing above U+10FFFF.
+
+#pragma once
+
+#include <bev/string_view.hpp>
+
+#include <iterator>
+
+namespace bev {
+namespace utf8 {
+
+// The code point that `code_point_iterator` returns for invalid sequences.
+inline constexpr char32_t replacement_character = 0xfffd;
+
+// Whether all bytes of `str` are below 0x80, in which case it is valid UTF-8
+// with one code point per byte.
+constexpr bool
+is_ascii(basic_string_view<char> str) noexcept
+{
+#if defined(BEV_STRING_VIEW_HAS_KERNELS)
+  if (!BEV_STRING_VIEW_IS_CONSTANT_EVALUATED())
+    return detail::is_ascii_kernel(str.data(), str.size());
+#endif
+  for (char c : str)
+    if (static_cast<unsigned char>(c) >= 0x80)
+      return false;
+  return true;
+}
+
+// Whether `str` is valid UTF-8.
+constexpr bool
+validate(basic_string_view<char> str) noexcept
+{
+  if (str.empty())
+    return true;
+#if defined(BEV_STRING_VIEW_HAS_KERNELS)
+  if (!BEV_STRING_VIEW_IS_CONSTANT_EVALUATED())
+    return detail::utf8_validate_kernel(str.data(), str.size());
+#endif
+  for (size_t i = 0; i < str.size();) {
+    char32_t cp = 0;
+    const size_t len = detail::decode_utf8(str.data() + i, str.size() - i, cp);
+    if (len == 0)
+      return false;
+    i += len;
+  }
+  return true;
+}
+
+// The number of code points in `str`, which has to be valid UTF-8. Counts
+// the bytes that are not continuation bytes, 8 at a time.
+constexpr size_t
+count_code_points(basic_string_view<char> str) noexcept
+{
+  const char* const p = str.data();
+  const size_t n = str.size();
+  size_t continuations = 0;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    // Bit 7 of every byte of the form 10xxxxxx.
+    const uint64_t v = detail::load_le_<uint64_t>(p + i);
+    const uint64_t mask = v & ~(v << 1) & 0x8080808080808080ull;
+    continuations += ((mask >> 7) * 0x0101010101010101ull) >> 56;
+  }
+  for (; i < n; ++i)
+    continuations += (static_cast<unsigned char>(p[i]) & 0xc0) == 0x80;
+  return n - continuations;
+}
+
+// The longest prefix of `str` of at most `max_bytes` bytes that doesn't end
+// in the middle of a sequence. Like `substr()` it sets the safederef flag if
+// it is shorter than `str`.
+constexpr basic_string_view<char>
+truncate_to_boundary(basic_string_view<char> str, size_t max_bytes) noexcept
+{
+  if (max_bytes >= str.size())
+    return str;
+  // At most three continuation bytes belong to the cut sequence.
+  size_t end = max_bytes;
+  while (end > 0 && max_bytes - end < 3
+         && (static_cast<unsigned char>(str[end]) & 0xc0) == 0x80)
+    --end;
+  if ((static_cast<unsigned char>(str[end]) & 0xc0) == 0x80)
+    end = max_bytes;
+  return str.take(end);
+}
+
+  /**
+   *  @brief  An iterator over the code points of a UTF-8 view.
+   *
+   *  Every invalid sequence is returned as one `replacement_character`, and
+   *  iteration continues with the next byte.
+   */
+class code_point_iterator
+{
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type        = char32_t;
+  using difference_type   = ptrdiff_t;
+  using pointer           = const char32_t*;
+  using reference         = char32_t;
+
+  constexpr
+  code_point_iterator() noexcept = default;
+
+  // An iterator at `p`, which decodes sequences up to `end`.
+  constexpr
+  code_point_iterator(const char* p, const char* end) noexcept
+    : p_{p}, end_{end}
+  { this->decode(); }
+
+  constexpr char32_t
+  operator*() const noexcept
+  { return cp_; }
+
+  constexpr code_point_iterator&
+  operator++() noexcept
+  {
+    p_ += len_;
+    this->decode();
+    return *this;
+  }
+
+  constexpr code_point_iterator
+  operator++(int) noexcept
+  {
+    code_point_iterator result = *this;
+    ++*this;
+    return result;
+  }
+
+  // The position of the current code point.
+  constexpr const char*
+  base() const noexcept
+  { return p_; }
+
+  // The number of bytes of the current code point, which is 1 for invalid
+  // sequences.
+  constexpr size_t
+  length() const noexcept
+  { return len_; }
+
+  friend constexpr bool
+  operator==(const code_point_iterator& x,
+             const code_point_iterator& y) noexcept
+  { return x.p_ == y.p_; }
+
+  friend constexpr bool
+  operator!=(const code_point_iterator& x,
+             const code_point_iterator& y) noexcept
+  { return x.p_ != y.p_; }
+
+private:
+  constexpr void
+  decode() noexcept
+  {
+    if (p_ == end_) {
+      len_ = 0;
+      return;
+    }
+    len_ = detail::decode_utf8(p_, static_cast<size_t>(end_ - p_), cp_);
+    if (len_ == 0) {
+      cp_ = replacement_character;
+      len_ = 1;
+    }
+  }
+
+  const char* p_ = nullptr;
+  const char* end_ = nullptr;
+  char32_t cp_ = 0;
+  size_t len_ = 0;
+};
+
+  /**
+   *  @brief  The code points of a UTF-8 view, for range-based for loops.
+   */
+class code_point_range
+{
+public:
+  constexpr explicit
+  code_point_range(basic_string_view<char> str) noexcept
+    : str_{str}
+  { }
+
+  constexpr code_point_iterator
+  begin() const noexcept
+  { return code_point_iterator{str_.data(), str_.data() + str_.size()}; }
+
+  constexpr code_point_iterator
+  end() const noexcept
+  {
+    const char* const end = str_.data() + str_.size();
+    return code_point_iterator{end, end};
+  }
+
+private:
+  basic_string_view<char> str_;
+};
+
+constexpr code_point_range
+code_points(basic_string_view<char> str) noexcept
+{ return code_point_range{str}; }
+
+} // namespace utf8
+} // namespace bev
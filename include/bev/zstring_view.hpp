@@ -0,0 +1,231 @@
+// A view of a null-terminated string, which carries the guarantee of the
+// terminator in its type instead of checking it at runtime:
+//
+//     int open_readonly(bev::zstring_view path)
+//     { return ::open(path.c_str(), O_RDONLY); }
+//
+//     open_readonly("/etc/hosts");
+//     open_readonly(config.path);                        // std::string
+//     open_readonly(bev::zstring_view::from_view(sv));   // checked
+//
+// A `bev::basic_zstring_view` can only be created from sources that are
+// known to be null-terminated: character pointers, `std::basic_string`,
+// `_zsv` literals, views for which `is_cstring()` is true, or pointer and
+// length pairs tagged with `bev::null_terminated`. So `c_str()` never needs
+// to check or copy. It converts implicitly to `bev::basic_string_view`, with
+// the safederef flag set.
+//
+// Removing characters from the front keeps the terminator, so suffixes are
+// zstring views as well, while other substrings are plain views.
+
+#pragma once
+
+#include <bev/string_view.hpp>
+
+#include <stdexcept>
+
+namespace bev {
+
+// Tag type for the constructor of `basic_zstring_view` from a pointer and
+// length pair, for which the caller guarantees that `str[len]` is zero.
+struct null_terminated_t { explicit null_terminated_t() = default; };
+inline constexpr null_terminated_t null_terminated{};
+
+  /**
+   *  @brief  A non-owning reference to a null-terminated string.
+   *
+   *  @tparam CharT   Type of character
+   *  @tparam Traits  Traits for character type
+   *
+   *  The character at `data()[size()]` is always `CharT{0}`, as long as the
+   *  referenced string is not modified.
+   */
+template<typename CharT, typename Traits = std::char_traits<CharT>>
+class basic_zstring_view
+{
+public:
+  using view_type       = basic_string_view<CharT, Traits>;
+  using traits_type     = Traits;
+  using value_type      = CharT;
+  using const_pointer   = const CharT*;
+  using const_reference = const CharT&;
+  using const_iterator  = typename view_type::const_iterator;
+  using iterator        = const_iterator;
+  using size_type       = size_t;
+  using difference_type = ptrdiff_t;
+  static constexpr size_type npos = size_type(-1);
+
+  // An empty string, which unlike the empty `basic_string_view` has a
+  // non-null `c_str()`.
+  constexpr
+  basic_zstring_view() noexcept
+    : view_{empty_, 0, safederef}
+  { }
+
+  constexpr
+  basic_zstring_view(const CharT* str) noexcept
+    : view_{str}
+  { }
+
+  basic_zstring_view(const std::basic_string<CharT, Traits>& s) noexcept
+    : view_{s}
+  { }
+
+  basic_zstring_view(std::basic_string<CharT, Traits>&&) = delete;
+
+  constexpr
+  basic_zstring_view(const CharT* str, size_type len, null_terminated_t) noexcept
+    : view_{str, len, safederef}
+  { }
+
+  // Returns a zstring view of `sv`, or throws `std::invalid_argument` if
+  // `sv.is_cstring()` is false.
+  static basic_zstring_view
+  from_view(view_type sv)
+  {
+    if (!sv.is_cstring())
+      throw std::invalid_argument("basic_zstring_view: not null-terminated");
+    return basic_zstring_view{sv.data(), sv.size(), null_terminated};
+  }
+
+  constexpr
+  operator view_type() const noexcept
+  { return view_; }
+
+  constexpr view_type
+  view() const noexcept
+  { return view_; }
+
+  constexpr const CharT*
+  c_str() const noexcept
+  { return view_.data(); }
+
+  constexpr const CharT*
+  data() const noexcept
+  { return view_.data(); }
+
+  constexpr size_type
+  size() const noexcept
+  { return view_.size(); }
+
+  constexpr size_type
+  length() const noexcept
+  { return view_.length(); }
+
+  [[nodiscard]] constexpr bool
+  empty() const noexcept
+  { return view_.empty(); }
+
+  constexpr const_iterator
+  begin() const noexcept
+  { return view_.begin(); }
+
+  constexpr const_iterator
+  end() const noexcept
+  { return view_.end(); }
+
+  constexpr const_reference
+  operator[](size_type pos) const noexcept
+  { return view_[pos]; }
+
+  constexpr const_reference
+  at(size_type pos) const
+  { return view_.at(pos); }
+
+  constexpr const_reference
+  front() const noexcept
+  { return view_.front(); }
+
+  constexpr const_reference
+  back() const noexcept
+  { return view_.back(); }
+
+  constexpr void
+  remove_prefix(size_type n) noexcept
+  { view_.remove_prefix(n); }
+
+  // The suffix starting at `pos`, which is still null-terminated.
+  constexpr basic_zstring_view
+  substr(size_type pos) const
+  {
+    if (pos > this->size())
+      throw std::out_of_range("basic_zstring_view::substr");
+    return basic_zstring_view{this->data() + pos, this->size() - pos,
+                              null_terminated};
+  }
+
+  constexpr view_type
+  substr(size_type pos, size_type n) const
+  { return view_.substr(pos, n); }
+
+  constexpr void
+  swap(basic_zstring_view& sv) noexcept
+  { view_.swap(sv.view_); }
+
+  friend constexpr bool
+  operator==(basic_zstring_view x, basic_zstring_view y) noexcept
+  { return x.view_ == y.view_; }
+
+  friend constexpr bool
+  operator!=(basic_zstring_view x, basic_zstring_view y) noexcept
+  { return x.view_ != y.view_; }
+
+  friend constexpr bool
+  operator< (basic_zstring_view x, basic_zstring_view y) noexcept
+  { return x.view_ < y.view_; }
+
+  friend constexpr bool
+  operator> (basic_zstring_view x, basic_zstring_view y) noexcept
+  { return x.view_ > y.view_; }
+
+  friend constexpr bool
+  operator<=(basic_zstring_view x, basic_zstring_view y) noexcept
+  { return x.view_ <= y.view_; }
+
+  friend constexpr bool
+  operator>=(basic_zstring_view x, basic_zstring_view y) noexcept
+  { return x.view_ >= y.view_; }
+
+private:
+  static constexpr CharT empty_[1] = {};
+
+  view_type view_;
+};
+
+// basic_zstring_view typedef names
+using zstring_view = basic_zstring_view<char>;
+using wzstring_view = basic_zstring_view<wchar_t>;
+using u16zstring_view = basic_zstring_view<char16_t>;
+using u32zstring_view = basic_zstring_view<char32_t>;
+
+// zstring view literals
+
+inline constexpr basic_zstring_view<char>
+operator""_zsv(const char* str, size_t len) noexcept
+{ return basic_zstring_view<char>{str, len, null_terminated}; }
+
+inline constexpr basic_zstring_view<wchar_t>
+operator""_zsv(const wchar_t* str, size_t len) noexcept
+{ return basic_zstring_view<wchar_t>{str, len, null_terminated}; }
+
+inline constexpr basic_zstring_view<char16_t>
+operator""_zsv(const char16_t* str, size_t len) noexcept
+{ return basic_zstring_view<char16_t>{str, len, null_terminated}; }
+
+inline constexpr basic_zstring_view<char32_t>
+operator""_zsv(const char32_t* str, size_t len) noexcept
+{ return basic_zstring_view<char32_t>{str, len, null_terminated}; }
+
+} // namespace bev
+
+namespace std {
+
+template<typename CharT>
+struct hash<bev::basic_zstring_view<CharT>>
+{
+  constexpr size_t
+  operator()(const bev::basic_zstring_view<CharT>& str) const noexcept
+  { return bev::hash<>{}(str.view()); }
+};
+
+} // namespace std
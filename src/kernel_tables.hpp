@@ -0,0 +1,25 @@
+// The kernel tables compiled into `bev::string_view_simd`, each of them
+// defined in a separate translation unit with the compiler flags for its
+// instruction set.
+
+#pragma once
+
+#include <bev/detail/simd.hpp>
+
+namespace bev {
+namespace detail {
+
+// The portable kernels.
+extern const kernel_table scalar_kernels;
+
+// The kernels for the instruction sets enabled by the default compiler
+// flags, i.e. SSE2 on x86-64 and NEON on AArch64.
+extern const kernel_table baseline_kernels;
+
+#if defined(BEV_STRING_VIEW_X86_KERNELS)
+extern const kernel_table ssse3_kernels;
+extern const kernel_table avx2_kernels;
+#endif
+
+} // namespace detail
+} // namespace bev
@@ -0,0 +1,11 @@
+// The kernels for AVX2, this file is compiled with `-mavx2`.
+
+#include "kernel_tables.hpp"
+
+namespace bev {
+namespace detail {
+
+const kernel_table avx2_kernels = BEV_STRING_VIEW_ISA_NAMESPACE::table;
+
+} // namespace detail
+} // namespace bev
@@ -0,0 +1,11 @@
+// The kernels for the instruction sets enabled by the default compiler flags.
+
+#include "kernel_tables.hpp"
+
+namespace bev {
+namespace detail {
+
+const kernel_table baseline_kernels = BEV_STRING_VIEW_ISA_NAMESPACE::table;
+
+} // namespace detail
+} // namespace bev
@@ -0,0 +1,14 @@
+// The portable kernels. They are compiled without any of the vector code,
+// but the compiler may still auto-vectorize them for the baseline.
+
+#define BEV_STRING_VIEW_NO_SIMD 1
+
+#include "kernel_tables.hpp"
+
+namespace bev {
+namespace detail {
+
+const kernel_table scalar_kernels = BEV_STRING_VIEW_ISA_NAMESPACE::table;
+
+} // namespace detail
+} // namespace bev
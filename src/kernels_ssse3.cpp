@@ -0,0 +1,11 @@
+// The kernels for SSSE3, this file is compiled with `-mssse3`.
+
+#include "kernel_tables.hpp"
+
+namespace bev {
+namespace detail {
+
+const kernel_table ssse3_kernels = BEV_STRING_VIEW_ISA_NAMESPACE::table;
+
+} // namespace detail
+} // namespace bev
@@ -0,0 +1,211 @@
+// Selection of the kernel table used by `bev::string_view_simd`, see
+// `bev/simd.hpp`.
+
+#include <bev/simd.hpp>
+
+#include "kernel_tables.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace bev {
+namespace detail {
+
+namespace {
+
+// All tables compiled into the library, in increasing order of preference.
+const kernel_table* const tables[] = {
+  &scalar_kernels,
+  &baseline_kernels,
+#if defined(BEV_STRING_VIEW_X86_KERNELS)
+  &ssse3_kernels,
+  &avx2_kernels,
+#endif
+};
+
+bool
+cpu_supports(isa_level level) noexcept
+{
+#if defined(BEV_STRING_VIEW_X86_KERNELS)
+  // The feature bits are only set up by a static constructor of libgcc,
+  // which may not have run yet if a kernel is called from another static
+  // constructor.
+  __builtin_cpu_init();
+#endif
+  switch (level) {
+#if defined(BEV_STRING_VIEW_X86_KERNELS)
+  case isa_level::ssse3:
+    return __builtin_cpu_supports("ssse3");
+  case isa_level::avx2:
+    return __builtin_cpu_supports("avx2");
+#endif
+  default:
+    // Everything else is part of the baseline the library was compiled for.
+    return true;
+  }
+}
+
+// Returns the table for `level`, or null if it is not available.
+const kernel_table*
+find_table(isa_level level) noexcept
+{
+  if (!cpu_supports(level))
+    return nullptr;
+  for (const kernel_table* table : tables)
+    if (table->level == level)
+      return table;
+  return nullptr;
+}
+
+const kernel_table*
+select_table() noexcept
+{
+  if (const char* name = std::getenv("BEV_STRING_VIEW_ISA")) {
+    for (const kernel_table* table : tables)
+      if (std::strcmp(name, isa_name(table->level)) == 0)
+        if (const kernel_table* forced = find_table(table->level))
+          return forced;
+  }
+
+  const kernel_table* best = &scalar_kernels;
+  for (const kernel_table* table : tables)
+    if (table->level > best->level && cpu_supports(table->level))
+      best = table;
+  return best;
+}
+
+extern const kernel_table resolver_kernels;
+
+// Selects the table on the first call of any kernel. A concurrent call of
+// `force_isa()` takes precedence.
+const kernel_table&
+resolve() noexcept
+{
+  const kernel_table* expected = &resolver_kernels;
+  const kernel_table* selected = select_table();
+  if (!active_kernels.compare_exchange_strong(expected, selected,
+                                              std::memory_order_relaxed))
+    return *expected;
+  return *selected;
+}
+
+size_t
+find_stub(const char* hay, size_t n, const char* s, size_t m) noexcept
+{ return resolve().find(hay, n, s, m); }
+
+size_t
+rfind_stub(const char* hay, size_t n, const char* s, size_t m) noexcept
+{ return resolve().rfind(hay, n, s, m); }
+
+size_t
+rfind_char_stub(const char* p, size_t n, char c) noexcept
+{ return resolve().rfind_char(p, n, c); }
+
+size_t
+find_first_of_stub(const char* p, size_t n, const byte_class& c) noexcept
+{ return resolve().find_first_of(p, n, c); }
+
+size_t
+find_first_not_of_stub(const char* p, size_t n, const byte_class& c) noexcept
+{ return resolve().find_first_not_of(p, n, c); }
+
+size_t
+find_last_of_stub(const char* p, size_t n, const byte_class& c) noexcept
+{ return resolve().find_last_of(p, n, c); }
+
+size_t
+find_last_not_of_stub(const char* p, size_t n, const byte_class& c) noexcept
+{ return resolve().find_last_not_of(p, n, c); }
+
+bool
+equal_stub(const char* a, const char* b, size_t n) noexcept
+{ return resolve().equal(a, b, n); }
+
+size_t
+teddy_stub(const char* p, size_t n, const teddy_masks& t) noexcept
+{ return resolve().teddy(p, n, t); }
+
+uint64_t
+class_bitmask_stub(const char* p, size_t n, const byte_class& c) noexcept
+{ return resolve().class_bitmask(p, n, c); }
+
+int
+ci_compare_stub(const char* a, const char* b, size_t n) noexcept
+{ return resolve().ci_compare(a, b, n); }
+
+size_t
+ci_find_stub(const char* p, size_t n, char c) noexcept
+{ return resolve().ci_find(p, n, c); }
+
+bool
+is_ascii_stub(const char* p, size_t n) noexcept
+{ return resolve().is_ascii(p, n); }
+
+bool
+utf8_validate_stub(const char* p, size_t n) noexcept
+{ return resolve().utf8_validate(p, n); }
+
+const kernel_table resolver_kernels = {
+  isa_level::scalar,
+  &find_stub,
+  &rfind_stub,
+  &rfind_char_stub,
+  &find_first_of_stub,
+  &find_first_not_of_stub,
+  &find_last_of_stub,
+  &find_last_not_of_stub,
+  &equal_stub,
+  &teddy_stub,
+  &class_bitmask_stub,
+  &ci_compare_stub,
+  &ci_find_stub,
+  &is_ascii_stub,
+  &utf8_validate_stub,
+};
+
+} // namespace
+
+// Constant-initialized, so that kernels called from static constructors in
+// other translation units find the resolver.
+std::atomic<const kernel_table*> active_kernels{&resolver_kernels};
+
+} // namespace detail
+
+isa_level
+active_isa() noexcept
+{
+  const detail::kernel_table* table =
+      detail::active_kernels.load(std::memory_order_relaxed);
+  if (table == &detail::resolver_kernels)
+    return detail::resolve().level;
+  return table->level;
+}
+
+bool
+isa_supported(isa_level level) noexcept
+{ return detail::find_table(level) != nullptr; }
+
+bool
+force_isa(isa_level level) noexcept
+{
+  const detail::kernel_table* table = detail::find_table(level);
+  if (!table)
+    return false;
+  detail::active_kernels.store(table, std::memory_order_relaxed);
+  return true;
+}
+
+const char*
+isa_name(isa_level level) noexcept
+{
+  switch (level) {
+  case isa_level::scalar: return "scalar";
+  case isa_level::sse2: return "sse2";
+  case isa_level::ssse3: return "ssse3";
+  case isa_level::avx2: return "avx2";
+  case isa_level::neon: return "neon";
+  }
+  return "unknown";
+}
+
+} // namespace bev
@@ -1,8 +1,1381 @@
 #include <bev/string_view.hpp>
+#include <bev/cached_string_view.hpp>
+#include <bev/ci_string_view.hpp>
+#include <bev/cstring_batch.hpp>
+#include <bev/hashed_string_view.hpp>
+#include <bev/static_map.hpp>
+#include <bev/segmented_string_view.hpp>
+#include <bev/sorted_view_set.hpp>
+#include <bev/incremental_searcher.hpp>
+#include <bev/mapped_file.hpp>
+#include <bev/multi_searcher.hpp>
+#include <bev/offset_view.hpp>
+#include <bev/parallel.hpp>
+#include <bev/parse.hpp>
+#include <bev/searcher.hpp>
+#include <bev/split.hpp>
+#include <bev/stats.hpp>
+#include <bev/string_interner.hpp>
+#include <bev/utf8.hpp>
+#include <bev/zstring_view.hpp>
+#if defined(BEV_STRING_VIEW_RUNTIME_DISPATCH)
+#include <bev/simd.hpp>
+#endif
+
+#if __has_include(<fmt/format.h>)
+#define FMT_HEADER_ONLY
+#include <bev/fmt.hpp>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#if defined(_WIN32)
+#  include <process.h>
+#else
+#  include <unistd.h>
+#endif
+
+static bool test_cstring_arg() {
+	std::string path("/usr/local/bin");
+	bev::string_view sv{path};
+
+	// A c-string is passed through without copying.
+	auto arg = sv.c_str_or_copy();
+	bool ok = arg.c_str() == path.c_str() && !arg.copied();
+
+	// A prefix is copied into the inline buffer.
+	auto prefix = sv.substr(0, 4).c_str_or_copy();
+	ok = ok && prefix.copied() && !prefix.heap_allocated()
+		&& std::strcmp(prefix.c_str(), "/usr") == 0;
+
+	// A prefix that doesn't fit into the inline buffer goes to the heap.
+	auto small = sv.substr(0, 4).c_str_or_copy<4>();
+	ok = ok && small.heap_allocated() && std::strcmp(small.c_str(), "/usr") == 0;
+
+	// A caller-provided buffer is used if the prefix fits.
+	char buf[8];
+	auto external = sv.substr(0, 4).c_str_or_copy(buf, sizeof(buf));
+	ok = ok && external.c_str() == buf && std::strcmp(buf, "/usr") == 0;
+
+	// A default-constructed view becomes an empty string.
+	bev::cstring_arg empty{bev::string_view{}};
+	ok = ok && empty.c_str()[0] == '\0';
+
+	return ok;
+}
+
+// Builds a deterministic pseudo-random string over a small alphabet, so that
+// partial matches are frequent.
+static std::string make_text(size_t len, unsigned seed) {
+	std::string result;
+	for (size_t i = 0; i < len; ++i) {
+		seed = seed * 1103515245u + 12345u;
+		result.push_back("abc"[(seed >> 16) % 3]);
+	}
+	return result;
+}
+
+static bool test_find() {
+	static_assert(bev::string_view("hello world").find("wor", 0, 3) == 6);
+	static_assert(bev::string_view("hello world").find("word", 0, 4) == bev::string_view::npos);
+	static_assert(bev::string_view("a/b/c").rfind('/') == 3);
+	static_assert(bev::string_view("a\r\nb\r\n").rfind("\r\n", 3) == 1);
+
+	bool ok = true;
+	for (size_t len = 0; len < 100; ++len) {
+		const std::string text = make_text(len, unsigned(len));
+		const bev::string_view bsv{text};
+		const std::string_view ssv{text};
+		for (size_t m = 0; m < 7; ++m) {
+			const std::string needle = make_text(m, unsigned(len + m));
+			for (size_t pos = 0; pos <= len + 1; ++pos)
+				ok = ok && bsv.find(needle.data(), pos, m) == ssv.find(needle.data(), pos, m)
+					&& bsv.rfind(needle.data(), len - pos, m) == ssv.rfind(needle.data(), len - pos, m);
+			ok = ok && bsv.rfind('a', len - m) == ssv.rfind('a', len - m);
+		}
+	}
+	return ok;
+}
+
+static bool test_equal() {
+	static_assert(bev::string_view("content-length") == bev::string_view("content-length"));
+	static_assert(bev::string_view("content-length") != bev::string_view("content-type"));
+	static_assert(bev::string_view("a/b/c").ends_with("b/c"));
+
+	// Flip every byte of every length once, to hit both the head and the
+	// tail of the overlapping loads.
+	bool ok = true;
+	for (size_t len = 0; len < 100; ++len) {
+		const std::string text = make_text(len, unsigned(len));
+		std::string copy = text;
+		ok = ok && bev::string_view{text} == bev::string_view{copy};
+		for (size_t i = 0; i < len; ++i) {
+			copy[i] ^= 0x20;
+			ok = ok && bev::string_view{text} != bev::string_view{copy}
+				&& !bev::string_view{copy}.ends_with(bev::string_view{text}.substr(i));
+			copy[i] ^= 0x20;
+		}
+	}
+	return ok;
+}
+
+static bool test_find_of() {
+	static_assert(bev::string_view("key: value").find_first_of(" :") == 3);
+	static_assert(bev::string_view("  value  ").find_last_not_of(" \t") == 6);
+
+	// The second set can not be represented by the nibble tables of the
+	// vectorized classification, the third one contains non-ASCII bytes.
+	const std::string sets[] = {" \t\r\n,;:", "\x01\x12#4EVgx\x89", "a\xff"};
+	const std::string alphabet = "ab \t\r\n,;:#4Egx\x89\xff";
+	bool ok = true;
+	for (size_t len = 0; len < 100; ++len) {
+		std::string text;
+		unsigned seed = unsigned(len);
+		for (size_t i = 0; i < len; ++i) {
+			seed = seed * 1103515245u + 12345u;
+			text.push_back(alphabet[(seed >> 16) % alphabet.size()]);
+		}
+		const bev::string_view bsv{text};
+		const std::string_view ssv{text};
+		for (const std::string& set : sets) {
+			const bev::char_set cs{set};
+			for (size_t pos = 0; pos <= len + 1; ++pos) {
+				const size_t rpos = len - pos;
+				ok = ok
+					&& bsv.find_first_of(set.data(), pos, set.size()) == ssv.find_first_of(set, pos)
+					&& bsv.find_first_not_of(set.data(), pos, set.size()) == ssv.find_first_not_of(set, pos)
+					&& bsv.find_last_of(set.data(), rpos, set.size()) == ssv.find_last_of(set, rpos)
+					&& bsv.find_last_not_of(set.data(), rpos, set.size()) == ssv.find_last_not_of(set, rpos)
+					&& bsv.find_first_of(cs, pos) == ssv.find_first_of(set, pos)
+					&& bsv.find_last_not_of(cs, rpos) == ssv.find_last_not_of(set, rpos);
+			}
+		}
+	}
+	return ok;
+}
+
+constexpr char hash_text[] =
+	"The quick brown fox jumps over the lazy dog, again and again and again.";
+
+// Hashes of all prefixes of `hash_text`, computed at compile time.
+template<typename Algorithm>
+constexpr std::array<size_t, sizeof(hash_text)> prefix_hashes() {
+	std::array<size_t, sizeof(hash_text)> result{};
+	for (size_t i = 0; i < result.size(); ++i)
+		result[i] = bev::hash<Algorithm>{}(bev::string_view(hash_text, i));
+	return result;
+}
+
+template<typename Algorithm>
+static bool test_hash_algorithm() {
+	constexpr auto expected = prefix_hashes<Algorithm>();
+	const std::string text(hash_text);
+	std::unordered_set<size_t> seen;
+	bool ok = true;
+	for (size_t i = 0; i < expected.size(); ++i) {
+		const bev::string_view sv = bev::string_view{text}.substr(0, i);
+		ok = ok && bev::hash<Algorithm>{}(sv) == expected[i];
+		seen.insert(expected[i]);
+	}
+	return ok && seen.size() == expected.size();
+}
+
+static bool test_hash() {
+	bool ok = test_hash_algorithm<bev::wyhash>()
+		&& test_hash_algorithm<bev::murmur2>();
+
+	const std::string text(hash_text);
+	const bev::string_view sv{text};
+	ok = ok && std::hash<bev::string_view>{}(sv) == bev::hash<>{}(sv);
+#if defined(__GLIBCXX__)
+	// The Murmur hash is the one used by libstdc++ for 64-bit size_t.
+	if (sizeof(size_t) == 8)
+		ok = ok && bev::hash<bev::murmur2>{}(sv) == std::hash<std::string_view>{}(text);
+#endif
+	return ok;
+}
+
+static bool test_hashed_string_view() {
+	constexpr bev::hashed_string_view key{"content-length"};
+	static_assert(key.hash() == bev::hash<>::hash64(bev::string_view{"content-length"})
+		&& sizeof(key.hash()) == 8);
+
+	const std::string text("content-length");
+	const bev::hashed_string_view hsv{bev::string_view{text}};
+	bool ok = hsv == key && hsv.is_cstring()
+		&& hsv == text && text == hsv
+		&& hsv != bev::hashed_string_view{"content-type"};
+
+	bev::transparent_hash hash;
+	bev::transparent_equal_to eq;
+	ok = ok && hash(text) == hash(hsv) && hash(text.c_str()) == hash(hsv)
+		&& std::hash<bev::hashed_string_view>{}(hsv) == hash(text)
+		&& eq(text, hsv) && eq(hsv, key) && !eq(hsv, "content-type");
+
+	std::unordered_map<std::string, int, bev::transparent_hash, bev::transparent_equal_to> map;
+	map["content-length"] = 1;
+#if defined(__cpp_lib_generic_unordered_lookup)
+	ok = ok && map.find(key) != map.end();
+#endif
+
+	// The hashes of case-insensitive views are those of the folded bytes,
+	// which would look into the wrong bucket.
+	using ci_hashed = bev::basic_hashed_string_view<char, bev::ascii_ci_traits>;
+	static_assert(!std::is_invocable_v<bev::transparent_hash, const ci_hashed&>
+		&& !std::is_invocable_v<bev::transparent_equal_to, const ci_hashed&, const ci_hashed&>);
+	const ci_hashed ci{bev::ci_string_view{"Ab"}};
+	ok = ok && ci.hash() != hash("Ab") && ci == ci_hashed{bev::ci_string_view{"aB"}};
+	return ok;
+}
+
+static bool test_literals() {
+	using namespace bev;
+	static_assert("foo"_sv.size() == 3);
+	static_assert("a\0b"_sv.size() == 3);
+	static_assert("GET"_hsv.hash() == bev::hash<>::hash64("GET"_sv)
+		&& static_cast<size_t>("GET"_hsv.hash()) == bev::hash<>{}("GET"_sv)
+		&& "GET"_hsv.hash() == bev::default_hash_algorithm::hash_bytes("GET", 3));
+	static_assert("GET"_hsv.hash() != "PUT"_hsv.hash());
+
+	constexpr auto hsv = "content-length"_hsv;
+	bool ok = "foo"_sv.is_cstring() && L"foo"_sv.is_cstring()
+		&& u"foo"_sv.is_cstring() && U"foo"_sv.is_cstring()
+		&& hsv.is_cstring() && hsv == bev::hashed_string_view{"content-length"};
+
+	const char buf[] = {'a', 'b', '\0'};
+	ok = ok && bev::string_view(buf, 2, bev::safederef).is_cstring()
+		&& !bev::string_view(buf, 1, bev::safederef).is_cstring()
+		&& !bev::string_view(buf, 2).is_cstring();
+	return ok;
+}
+
+static bool test_static_map() {
+	using namespace bev;
+	static constexpr string_view headers[] = {
+		"accept"_sv, "accept-encoding"_sv, "accept-language"_sv, "authorization"_sv,
+		"cache-control"_sv, "connection"_sv, "content-encoding"_sv, "content-length"_sv,
+		"content-type"_sv, "cookie"_sv, "date"_sv, "etag"_sv, "expect"_sv, "host"_sv,
+		"if-modified-since"_sv, "if-none-match"_sv, "last-modified"_sv, "location"_sv,
+		"origin"_sv, "pragma"_sv, "range"_sv, "referer"_sv, "server"_sv,
+		"set-cookie"_sv, "transfer-encoding"_sv, "upgrade"_sv, "user-agent"_sv, "vary"_sv};
+	static constexpr auto index = make_static_map(headers);
+	static constexpr auto verbs = make_static_map<int>({
+		{"GET"_sv, 1}, {"HEAD"_sv, 2}, {"POST"_sv, 3}, {"PUT"_sv, 4}, {"DELETE"_sv, 5}});
+	static_assert(*verbs.find("POST"_sv) == 3);
+	static_assert(verbs.find("PATCH"_sv) == nullptr);
+	static_assert(index.at("host"_sv) == 13);
+
+	bool ok = verbs.find("GET"_hsv) && *verbs.find("GET"_hsv) == 1;
+	for (size_t i = 0; i < index.size(); ++i) {
+		const std::string key(headers[i].data(), headers[i].size());
+		const std::string longer = key + "x";
+		ok = ok && index.at(bev::string_view{key}) == i
+			&& !index.contains(bev::string_view{longer})
+			&& !index.contains(bev::string_view{key}.substr(1));
+	}
+	return ok;
+}
+
+static bool test_segmented_string_view() {
+	static constexpr bev::string_view parts[] = {"GET /ind", "ex HTTP/1.1\r", "\n"};
+	static_assert(bev::segmented_string_view{parts}.find("\r\n") == 19);
+	static_assert(bev::segmented_string_view{parts}.substr(4, 6).contiguous() == false);
+	static_assert(bev::segmented_string_view{parts}.substr(11, 4).view() == "HTTP");
+
+	// The same text split into chunks of varying sizes, including empty ones.
+	const std::string text = make_text(64, 7) + "\r\n\r\n" + make_text(40, 8);
+	const std::string_view ssv{text};
+	const auto sign = [](int x) { return (x > 0) - (x < 0); };
+	bool ok = true;
+	for (size_t step = 1; step < 12; ++step) {
+		std::vector<bev::string_view> chunks;
+		for (size_t i = 0, k = 0; i < text.size(); ++k) {
+			const size_t len = std::min(k % (step + 1), text.size() - i);
+			chunks.push_back(bev::string_view{text}.substr(i, len));
+			i += len;
+		}
+		const bev::segmented_string_view seg{chunks};
+		ok = ok && seg.size() == text.size() && seg == bev::string_view{text}
+			&& std::string(seg.begin(), seg.end()) == text;
+		for (size_t pos = 0; pos < text.size(); pos += 5) {
+			for (size_t n : {size_t(0), size_t(1), size_t(7), size_t(30)}) {
+				const bev::segmented_string_view sub = seg.substr(pos, n);
+				const std::string_view expected = ssv.substr(pos, n);
+				std::string copied(expected.size(), '\0');
+				ok = ok && std::string(sub.begin(), sub.end()) == expected
+					&& sub.copy(&copied[0], n) == expected.size() && copied == expected
+					&& seg.find(bev::string_view(expected.data(), expected.size()))
+						== ssv.find(expected)
+					&& sign(sub.compare(bev::string_view{text})) == sign(expected.compare(ssv))
+					&& (!sub.contiguous() || sub.view() == bev::string_view(expected.data(), expected.size()));
+			}
+			ok = ok && seg.find("\r\n\r\n", pos) == ssv.find("\r\n\r\n", pos)
+				&& seg.find('c', pos) == ssv.find('c', pos)
+				&& seg.find_first_of("\r\n", pos) == ssv.find_first_of("\r\n", pos)
+				&& seg.find_first_not_of(bev::char_set{"abc"}, pos) == ssv.find_first_not_of("abc", pos)
+				&& seg[pos] == text[pos];
+		}
+	}
+	return ok;
+}
+
+static bool test_incremental_searcher() {
+	bool ok = true;
+	for (size_t m = 1; m < 7; ++m) {
+		const std::string needle = make_text(m, unsigned(m));
+		const std::string text = make_text(300, unsigned(m + 100));
+		std::vector<size_t> expected;
+		for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1))
+			expected.push_back(pos);
+
+		// Feed the text in chunks of 0 to `step` characters.
+		for (size_t step = 1; step < 10; ++step) {
+			bev::incremental_searcher searcher{bev::string_view{needle}};
+			std::vector<size_t> found;
+			size_t first = bev::incremental_searcher::npos;
+			for (size_t i = 0, k = 0; i < text.size(); ++k) {
+				const size_t len = std::min(k % (step + 1), text.size() - i);
+				searcher.feed(bev::string_view{text}.substr(i, len),
+					[&](size_t pos) { found.push_back(pos); });
+				i += len;
+			}
+			searcher.reset();
+			for (size_t i = 0; i < text.size() && first == bev::incremental_searcher::npos; i += step)
+				first = searcher.feed(bev::string_view{text}.substr(i, step));
+			ok = ok && found == expected
+				&& first == (expected.empty() ? bev::incremental_searcher::npos : expected[0]);
+		}
+	}
+	return ok;
+}
+
+static bool test_searcher() {
+	bool ok = true;
+	for (size_t m : {0, 1, 2, 3, 5, 8, 13, 63, 64, 65, 100}) {
+		// Periodic needles over a small alphabet, to exercise the Two-Way
+		// memory and partial matches for the Horspool shifts.
+		for (unsigned seed : {1u, 2u}) {
+			std::string needle = make_text(m, seed);
+			if (seed == 2)
+				for (size_t i = 2; i < m; ++i)
+					needle[i] = needle[i % 2];
+			const std::string text = make_text(500, seed + 10) + needle + make_text(200, seed + 20);
+			const std::wstring wneedle(needle.begin(), needle.end());
+			const std::wstring wtext(text.begin(), text.end());
+
+			const bev::searcher searcher{bev::string_view{needle}};
+			const bev::wsearcher wsearcher{bev::wstring_view{wneedle}};
+			ok = ok && (m >= bev::horspool_threshold || searcher.selected_algorithm() == bev::searcher::algorithm::kernel)
+				&& (m < 2 || wsearcher.selected_algorithm() == bev::wsearcher::algorithm::two_way);
+			for (size_t pos = 0; pos <= text.size() + 1; pos += 7) {
+				const size_t expected = std::string_view{text}.find(needle, pos);
+				ok = ok && bev::string_view{text}.find(searcher, pos) == expected
+					&& bev::wstring_view{wtext}.find(wsearcher, pos) == expected;
+			}
+			const auto it = std::search(text.begin(), text.end(), searcher);
+			ok = ok && size_t(it - text.begin()) == std::min(text.find(needle), text.size());
+		}
+	}
+
+	// A needle with many distinct characters, long enough for Horspool.
+	std::string needle;
+	for (int i = 0; i < 200; ++i)
+		needle.push_back(char(' ' + (i * 37) % 95));
+	const std::string text = make_text(1000, 3) + needle.substr(0, 199) + make_text(100, 4) + needle;
+	const bev::searcher searcher{bev::string_view{needle}};
+	ok = ok && searcher.selected_algorithm() == bev::searcher::algorithm::horspool;
+	for (size_t pos = 0; pos <= text.size(); pos += 13)
+		ok = ok && bev::string_view{text}.find(searcher, pos) == std::string_view{text}.find(needle, pos);
+	return ok;
+}
+
+static bool test_multi_searcher() {
+	using match = bev::multi_searcher::match;
+	const auto by_offset = [](match a, match b) {
+		return a.offset != b.offset ? a.offset < b.offset : a.pattern < b.pattern;
+	};
+	bool ok = true;
+	for (size_t count : {1, 3, 8, 20, 32, 33, 100}) {
+		const std::string text = make_text(1000, unsigned(count));
+		std::vector<std::string> storage;
+		for (size_t i = 0; i < count; ++i)
+			storage.push_back(make_text(1 + (i * 7) % 9, unsigned(100 + i)));
+		storage.push_back(storage[0]);
+		const std::vector<bev::string_view> patterns(storage.begin(), storage.end());
+		const bev::multi_searcher searcher{patterns};
+		ok = ok && searcher.selected_algorithm() == (patterns.size() <= bev::teddy_max_patterns
+			? bev::multi_searcher::algorithm::teddy : bev::multi_searcher::algorithm::aho_corasick);
+
+		std::vector<match> expected;
+		for (size_t id = 0; id < patterns.size(); ++id)
+			for (size_t pos = text.find(storage[id]); pos != std::string::npos; pos = text.find(storage[id], pos + 1))
+				expected.push_back({id, pos});
+		std::sort(expected.begin(), expected.end(), by_offset);
+		std::vector<match> found;
+		searcher.find_all(bev::string_view{text}, [&found](match m) { found.push_back(m); });
+		std::sort(found.begin(), found.end(), by_offset);
+		ok = ok && found.size() == expected.size()
+			&& std::equal(found.begin(), found.end(), expected.begin(),
+			              [](match a, match b) { return a.pattern == b.pattern && a.offset == b.offset; });
+
+		for (size_t pos = 0; pos <= text.size() + 1; pos += 37) {
+			const auto it = std::find_if(expected.begin(), expected.end(),
+			                             [pos](match m) { return m.offset >= pos; });
+			const match m = searcher.find(bev::string_view{text}, pos);
+			ok = ok && (it == expected.end()
+				? m.pattern == bev::multi_searcher::npos && m.offset == bev::multi_searcher::npos
+				: m.pattern == it->pattern && m.offset == it->offset);
+		}
+	}
+
+	const bev::multi_searcher attacks{"<script", "UNION SELECT", "../"};
+	ok = ok && attacks.contains_any("GET /../etc/passwd") && !attacks.contains_any("GET /index.html")
+		&& attacks.find("a=1 UNION SELECT <script").pattern == 1;
+	try {
+		bev::multi_searcher{"a", ""};
+		ok = false;
+	} catch (const std::invalid_argument&) {
+	}
+	return ok;
+}
+
+// The tokens of `text` split at any of `delims`, computed with std::string.
+static std::vector<std::string> split_reference(const std::string& text, const std::string& delims,
+                                                bool skip_empty, size_t max_splits) {
+	std::vector<std::string> result;
+	size_t pos = 0, splits = 0;
+	for (;;) {
+		if (skip_empty) {
+			pos = text.find_first_not_of(delims, pos);
+			if (pos == std::string::npos)
+				return result;
+		}
+		const size_t end = splits == max_splits ? std::string::npos : text.find_first_of(delims, pos);
+		if (end == std::string::npos) {
+			result.push_back(text.substr(pos));
+			return result;
+		}
+		result.push_back(text.substr(pos, end - pos));
+		pos = end + 1;
+		++splits;
+	}
+}
+
+static bool test_split() {
+	bool ok = true;
+	for (size_t len : {0, 1, 5, 63, 64, 65, 200}) {
+		const std::string text = make_text(len, unsigned(len));
+		const std::u16string wtext(text.begin(), text.end());
+		for (const std::string delims : {"a", "bc"}) {
+			const std::u16string wdelims(delims.begin(), delims.end());
+			for (bool skip : {false, true}) {
+				for (size_t max_splits : {size_t(0), size_t(3), size_t(-1)}) {
+					const bev::split_options options = skip ? bev::split_options{bev::skip_empty, max_splits}
+					                                        : bev::split_options{max_splits};
+					const std::vector<std::string> expected = split_reference(text, delims, skip, max_splits);
+					std::vector<std::string> tokens;
+					for (bev::string_view token : bev::split(bev::string_view{text}, delims, options))
+						tokens.push_back(std::string{token.data(), token.size()});
+					std::vector<std::string> from_set;
+					for (bev::string_view token : bev::split(bev::string_view{text}, bev::char_set{delims}, options))
+						from_set.push_back(std::string{token.data(), token.size()});
+					std::vector<std::string> wide;
+					for (bev::u16string_view token : bev::split(bev::u16string_view{wtext}, bev::u16string_view{wdelims}, options))
+						wide.push_back(std::string{token.begin(), token.end()});
+					ok = ok && tokens == expected && from_set == expected && wide == expected;
+				}
+			}
+		}
+	}
+
+	// Tokens followed by a delimiter have the safederef flag, the last one
+	// keeps the flag of the original view.
+	const std::string cstrings{"ab\0cd", 5};
+	const bev::string_view nul{"\0", 1};
+	std::vector<bev::string_view> tokens;
+	for (bev::string_view token : bev::split(bev::string_view{cstrings}, nul))
+		tokens.push_back(token);
+	ok = ok && tokens.size() == 2 && tokens[0].is_cstring() && tokens[1].is_cstring();
+	const bev::split_range unflagged = bev::split(bev::string_view{cstrings.data(), 5}, nul);
+	auto it = unflagged.begin();
+	ok = ok && it->is_cstring() && !(++it)->is_cstring() && ++it == unflagged.end();
+
+	const auto fields = bev::split(bev::string_view{"GET /index.html HTTP/1.1"}, ' ');
+	ok = ok && std::distance(fields.begin(), fields.end()) == 3 && *std::next(fields.begin()) == bev::string_view{"/index.html"};
+	return ok;
+}
+
+// Runs the chunks in reverse order, to check that the results don't depend
+// on the order in which they complete.
+struct reverse_executor {
+	template<typename F>
+	void bulk(size_t n, F f) const {
+		while (n-- > 0)
+			f(n);
+	}
+};
+
+static bool test_parallel() {
+	bool ok = true;
+	const std::string text = make_text(5000, 42);
+	const bev::string_view view{text};
+	const bev::parallel::thread_executor pool{4};
+	// A chunk size of 0 selects the default one.
+	for (size_t chunk_size : {0, 1, 7, 64, 1 << 20}) {
+		for (size_t m : {0, 1, 3, 8, 20}) {
+			// Needles from the middle of the text, so that they also occur in
+			// chunks after the first match.
+			const bev::string_view needle = view.substr(2500, m);
+			const size_t expected = std::string_view{text}.find(std::string_view{needle.data(), m});
+			ok = ok && bev::parallel::find(view, needle, pool, chunk_size) == expected
+				&& bev::parallel::find(view, needle, reverse_executor{}, chunk_size) == expected;
+		}
+		ok = ok && bev::parallel::find(view, "not in the text", pool, chunk_size) == bev::string_view::npos;
+
+		std::vector<size_t> expected_positions;
+		for (size_t pos = text.find('b'); pos != std::string::npos; pos = text.find('b', pos + 1))
+			expected_positions.push_back(pos);
+		ok = ok && bev::parallel::count(view, 'b', pool, chunk_size) == expected_positions.size()
+			&& bev::parallel::split_positions(view, 'b', pool, chunk_size) == expected_positions
+			&& bev::parallel::split_positions(view, 'b', reverse_executor{}, chunk_size) == expected_positions;
+	}
+	const std::u16string wide(text.begin(), text.end());
+	ok = ok && bev::parallel::count(bev::u16string_view{wide}, u'c', pool, 100)
+		== size_t(std::count(text.begin(), text.end(), 'c'));
+
+	try {
+		pool.bulk(100, [](size_t i) {
+			if (i == 50)
+				throw std::runtime_error("chunk failed");
+		});
+		ok = false;
+	} catch (const std::runtime_error&) {
+	}
+	return ok;
+}
+
+// Writes `contents` to a temporary file, maps it and checks the view. The
+// name contains the process id, since ctest runs the test binaries in parallel.
+static bool check_mapped_file(const std::string& contents, bool zero_terminated) {
+#if defined(_WIN32)
+	const std::string name = "sv_test_mapped_file." + std::to_string(_getpid()) + ".tmp";
+#else
+	const std::string name = "sv_test_mapped_file." + std::to_string(getpid()) + ".tmp";
+#endif
+	const char* const path = name.c_str();
+	std::FILE* file = std::fopen(path, "wb");
+	if (!file)
+		return false;
+	std::fwrite(contents.data(), 1, contents.size(), file);
+	std::fclose(file);
+
+	bev::mapped_file mapped{path};
+	const bev::mapped_file moved = std::move(mapped);
+	const bev::string_view view = moved.view();
+	const bool ok = mapped.empty() && view.size() == contents.size()
+		&& std::string_view{view.data(), view.size()} == contents
+		&& view.is_cstring() == zero_terminated
+		&& moved.advise(bev::mapped_file::advice::sequential);
+	std::remove(path);
+	return ok;
+}
+
+static bool test_mapped_file() {
+	const size_t page = bev::mapped_file::page_size();
+	bool ok = check_mapped_file("hello\n", true)
+		&& check_mapped_file(make_text(page + 1, 1), true)
+		&& check_mapped_file(make_text(page, 2), false)
+		// Empty files can not be mapped, but still have a null-terminated view.
+		&& check_mapped_file("", true);
+	try {
+		bev::mapped_file missing{"sv_test_does_not_exist.tmp"};
+		ok = false;
+	} catch (const std::system_error& e) {
+		ok = ok && e.code() == std::errc::no_such_file_or_directory;
+	}
+	return ok;
+}
+
+static bool test_string_interner() {
+	// Small blocks, so that the strings are spread over many of them.
+	bev::string_interner names{64};
+	const std::string text = make_text(20000, 3);
+	std::vector<bev::string_view> first;
+	bool ok = names.empty() && names.find("a").data() == nullptr;
+	for (size_t i = 0; i + 40 < text.size(); i += 7) {
+		// Lengths of 0 to 39, and a few longer than a quarter of a block.
+		const std::string word = text.substr(i, i % 40 + (i % 1000 == 0 ? 100 : 0));
+		const bev::string_view a = names.intern(word);
+		const bev::string_view b = names.intern(bev::string_view{word});
+		ok = ok && a.data() == b.data() && a == word && a.is_cstring()
+			&& a.data()[a.size()] == '\0' && a.data() != word.data()
+			&& names.find(word).data() == a.data();
+		first.push_back(a);
+	}
+	std::set<std::string> distinct;
+	for (bev::string_view word : first)
+		distinct.emplace(word.data(), word.size());
+	ok = ok && names.size() == distinct.size() && names.contains("")
+		&& !names.contains("not interned") && names.memory_usage() > 0;
+
+	// The views stay valid when the interner is moved, and the moved-from
+	// interner is empty and allocates its own memory when it is used again.
+	bev::string_interner moved = std::move(names);
+	const std::string copy{first[17].data(), first[17].size()};
+	ok = ok && moved.find(copy).data() == first[17].data() && names.empty() && !names.contains(copy);
+	const bev::string_view again = names.intern("AAAA");
+	const bev::string_view other = moved.intern("BBBB");
+	ok = ok && names.size() == 1 && again == "AAAA" && other == "BBBB" && again.data() != other.data();
+
+	bev::string_interner assigned;
+	assigned.intern("CCCC");
+	assigned = std::move(moved);
+	const bev::string_view after = moved.intern("DDDD");
+	ok = ok && assigned.find(copy).data() == first[17].data() && assigned.contains("BBBB")
+		&& !assigned.contains("CCCC") && moved.size() == 1 && assigned.intern("EEEE") != after
+		&& after == "DDDD" && again == "AAAA";
+	assigned.clear();
+	ok = ok && assigned.empty() && !assigned.contains(copy);
+
+	bev::concurrent_string_interner shared{5};
+	ok = ok && shared.shard_count() == 8;
+	std::vector<std::thread> threads;
+	std::vector<bev::string_view> interned[4];
+	for (int t = 0; t < 4; ++t) {
+		threads.emplace_back([&, t] {
+			for (const std::string& word : distinct)
+				interned[t].push_back(shared.intern(word));
+		});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+	ok = ok && shared.size() == distinct.size();
+	for (size_t i = 0; i < interned[0].size(); ++i) {
+		ok = ok && interned[0][i].is_cstring()
+			&& interned[1][i].data() == interned[0][i].data()
+			&& interned[2][i].data() == interned[0][i].data()
+			&& interned[3][i].data() == interned[0][i].data();
+	}
+	return ok;
+}
+
+// Stands in for a C API wrapper that needs a null-terminated argument.
+static size_t zstring_length(bev::zstring_view str) {
+	return std::strlen(str.c_str());
+}
+
+static bool test_zstring_view() {
+	using namespace bev;
+	static constexpr zstring_view literal = "header"_zsv;
+	static_assert(literal.size() == 6 && literal.c_str()[6] == '\0');
+	static_assert(literal.substr(2) == "ader" && literal.substr(1, 2) == "ea"_sv);
+
+	const std::string owned = "a std::string";
+	const char* const pointer = "a pointer";
+	bool ok = zstring_length(owned) == owned.size()
+		&& zstring_length(pointer) == 9
+		&& zstring_length("a literal") == 9
+		&& zstring_length(zstring_view{}) == 0
+		&& zstring_view{}.c_str() != nullptr;
+
+	// Conversions to views keep the safederef flag.
+	const string_view view = zstring_view{owned};
+	ok = ok && view.data() == owned.data() && view.is_cstring();
+
+	// Only views that are known to be null-terminated can be converted.
+	ok = ok && zstring_view::from_view(view.substr(2)).c_str() == owned.data() + 2;
+	try {
+		zstring_view::from_view(view.substr(0, 5));
+		ok = false;
+	} catch (const std::invalid_argument&) {
+	}
+	try {
+		literal.substr(7);
+		ok = false;
+	} catch (const std::out_of_range&) {
+	}
+
+	zstring_view suffix = owned;
+	suffix.remove_prefix(7);
+	ok = ok && suffix == "string" && suffix == "string"_sv && "string"_sv == suffix
+		&& suffix != owned && suffix < "t" && zstring_length(suffix) == 6;
+
+	const std::u16string wide = u"wide";
+	ok = ok && std::hash<u16zstring_view>{}(wide) == std::hash<u16string_view>{}(wide)
+		&& u16zstring_view{wide}.view().is_cstring();
+	return ok;
+}
+
+static bool test_cstring_batch() {
+	const std::string storage = "/usr/lib/x86_64";
+	const bev::string_view path{storage};
+	const std::vector<bev::string_view> views{
+		path, path.substr(0, 4), path.substr(5), bev::string_view{}, path.substr(0, 8), "literal"};
+	const std::vector<std::string> expected{"/usr/lib/x86_64", "/usr", "lib/x86_64", "", "/usr/lib", "literal"};
+
+	bev::cstring_batch batch;
+	bool ok = batch.empty() && batch.c_strs()[0] == nullptr;
+	const char* const* strs = batch.assign(views);
+	ok = ok && batch.size() == views.size() && strs == batch.c_strs()
+		&& strs[views.size()] == nullptr && batch.copied() == 3;
+	for (size_t i = 0; i < views.size(); ++i)
+		ok = ok && strs[i] == expected[i] && (views[i].is_cstring() == (strs[i] == views[i].data()));
+
+	// Reusing the batch for fewer strings doesn't allocate, and any range of
+	// convertible elements works.
+	const char* const buffer = strs[1];
+	const std::vector<std::string> owned{"a", "b"};
+	batch.assign(owned);
+	ok = ok && batch.size() == 2 && batch[0] == owned[0].data() && batch[1] == owned[1].data();
+	batch.assign({path.substr(0, 4), path.substr(0, 8)});
+	ok = ok && batch.copied() == 2 && batch[0] == buffer && batch[0] == std::string{"/usr"}
+		&& batch[1] == std::string{"/usr/lib"};
+
+	batch.clear();
+	ok = ok && batch.empty() && batch.c_strs()[0] == nullptr;
+
+	const std::wstring wide = L"wide";
+	const bev::wcstring_batch wide_batch{bev::wstring_view{wide}.substr(0, 2)};
+	ok = ok && wide_batch.size() == 1 && wide_batch.copied() == 1 && wide_batch[0] == std::wstring{L"wi"};
+	return ok;
+}
+
+static bool test_cached_string_view() {
+	using bev::cached_string_view;
+	static_assert(sizeof(cached_string_view) == sizeof(bev::string_view));
+
+	std::string storage = "key=value";
+	const bev::string_view view{storage};
+	const cached_string_view all{view};
+	const cached_string_view key = all.substr(0, 3);
+	const cached_string_view value = all.substr(4);
+	bool ok = all.is_cstring() && all.size() == 9 && !key.is_cstring() && key == "key"
+		&& value.is_cstring() && value == "value"
+		&& cached_string_view{view.substr(0, 3)}.is_cstring() == view.substr(0, 3).is_cstring();
+
+	// The terminator is checked again when the end moves into the view, also
+	// for views without the safederef flag.
+	storage[3] = '\0';
+	cached_string_view shorter = all;
+	shorter.remove_suffix(6);
+	const cached_string_view unflagged{bev::string_view{storage.data(), 9}};
+	ok = ok && shorter.is_cstring() && shorter.size() == 3 && all.substr(0, 3).is_cstring()
+		&& !unflagged.is_cstring() && unflagged.substr(0, 3).is_cstring();
+
+	// The cached result doesn't follow changes of the string.
+	ok = ok && !key.is_cstring() && key.view().is_cstring();
+	storage[3] = '=';
+
+	// Conversions keep the safederef flag.
+	ok = ok && bev::string_view{key}.substr(0, 3).data() == storage.data()
+		&& bev::string_view{all}.is_cstring()
+		&& !bev::string_view{cached_string_view{bev::string_view{storage.data(), 9}}}.is_cstring();
+
+	const char* const literal = "literal";
+	ok = ok && cached_string_view{literal}.is_cstring() && cached_string_view{storage}.is_cstring()
+		&& !cached_string_view{}.is_cstring() && cached_string_view{}.empty()
+		&& std::hash<cached_string_view>{}(all) == std::hash<bev::string_view>{}(view);
+
+	bool thrown = false;
+	try { (void)all.substr(10); } catch (const std::out_of_range&) { thrown = true; }
+	return ok && thrown && all.substr(9).empty() && all.substr(9).is_cstring();
+}
+
+static bool test_slicing() {
+	using namespace bev;
+	static constexpr string_view literal = "  \tkey = value\r\n"_sv;
+	static_assert(literal.trim() == "key = value" && literal.ltrim() == "key = value\r\n"
+		&& literal.rtrim() == "  \tkey = value" && literal.trim(" \tk\r\n"_sv) == "ey = value");
+	static_assert(literal.take(3) == "  \t" && literal.drop(100).empty()
+		&& literal.split_at(9).first == "  \tkey = " && literal.split_at(9).second == "value\r\n");
+
+	const std::string storage = "name: some value  ";
+	const string_view line{storage};
+	bool ok = true;
+	// Views ending before the end of the original one can be dereferenced
+	// after their end, even without the flag.
+	const string_view unflagged{storage.data(), 5};
+	ok = ok && !unflagged.is_cstring() && !unflagged.take(4).is_cstring()
+		&& unflagged.take(4).substr(1).take(100).data() == storage.data() + 1;
+	string_view shorter = unflagged;
+	shorter.remove_suffix(0);
+	ok = ok && !shorter.is_cstring();
+
+	const auto [name, rest] = line.split_at(line.find(':'));
+	const string_view value = rest.drop(1).trim();
+	ok = ok && name == "name" && rest == ": some value  " && value == "some value"
+		&& rest.is_cstring() && !name.is_cstring() && line.rtrim().size() == 16
+		&& line.drop(line.size()).is_cstring() && line.ltrim().is_cstring()
+		&& line.split_at(100).second.empty() && line.split_at(100).first == line;
+	static constexpr bev::char_set spaces_and_e{" e"};
+	ok = ok && value.trim(spaces_and_e) == "some valu" && line.take(6).ltrim(spaces_and_e) == "name: "
+		&& string_view{"   "}.trim().empty() && string_view{"   "}.trim().is_cstring()
+		&& string_view{}.trim().empty() && string_view{"x"}.trim() == "x";
+
+	// The same for other character types, which don't use the kernels.
+	const std::u16string wide = u" \t wide\n";
+	const u16string_view wide_view{wide};
+	ok = ok && wide_view.trim() == u"wide" && wide_view.ltrim() == u"wide\n"
+		&& wide_view.rtrim() == u" \t wide" && wide_view.trim(u" w\t\n") == u"ide"
+		&& wide_view.ltrim().is_cstring() && wide_view.trim().data()[4] == u'\n';
+
+	// Long runs of whitespace are skipped by the kernels.
+	const std::string padded = std::string(100, ' ') + "x" + std::string(100, '\t');
+	ok = ok && string_view{padded}.trim() == "x" && string_view{padded}.trim().data() == padded.data() + 100;
+	return ok;
+}
+
+// Whether `bev::parse<double>()` of `text` is identical to `strtod()`.
+static bool parses_like_strtod(const std::string& text) {
+	const auto result = bev::parse<double>(text);
+	const double expected = std::strtod(text.c_str(), nullptr);
+	return result && std::memcmp(&result.value, &expected, sizeof(double)) == 0;
+}
+
+static bool test_parse() {
+	using bev::parse;
+	static_assert(parse<int>("-123").value == -123 && parse<uint64_t>("18446744073709551615").value == UINT64_MAX);
+	static_assert(parse<int8_t>("128").ec == std::errc::result_out_of_range && parse<int8_t>("-128").value == -128);
+	// Only doubles may copy, and so throw, for `strtod()`.
+	static_assert(noexcept(parse<int>("1")) && !noexcept(parse<double>("1")));
+
+	bool ok = parse<int64_t>("9223372036854775807").value == INT64_MAX
+		&& parse<int64_t>("-9223372036854775808").value == INT64_MIN
+		&& parse<int64_t>("9223372036854775808").ec == std::errc::result_out_of_range
+		&& parse<uint64_t>("18446744073709551616").ec == std::errc::result_out_of_range
+		&& parse<uint64_t>("000000000000000000000000000042").value == 42
+		&& parse<uint64_t>("-1").ec == std::errc::invalid_argument
+		&& parse<int>("").ec == std::errc::invalid_argument
+		&& parse<int>("-").ec == std::errc::invalid_argument
+		&& parse<int>("+1").ec == std::errc::invalid_argument
+		&& parse<int>(" 1").ec == std::errc::invalid_argument
+		&& parse<int>("12a").ec == std::errc::invalid_argument
+		&& parse<unsigned>("1234567890123456789").ec == std::errc::result_out_of_range;
+
+	// All lengths, so that every mix of 8-digit chunks and single digits is
+	// covered, with a non-digit around the position of every chunk.
+	uint32_t x = 7;
+	for (int len = 1; len <= 20; ++len) {
+		for (int k = 0; k < 50; ++k) {
+			std::string digits;
+			for (int i = 0; i < len; ++i) {
+				x = x * 1664525u + 1013904223u;
+				digits += static_cast<char>('0' + (x >> 24) % 10);
+			}
+			errno = 0;
+			const unsigned long long expected = std::strtoull(digits.c_str(), nullptr, 10);
+			const auto result = parse<uint64_t>(digits);
+			ok = ok && (errno == ERANGE ? result.ec == std::errc::result_out_of_range
+			                            : result && result.value == expected);
+			std::string broken = digits + "0";
+			broken[static_cast<size_t>(len) / 2] = '/';
+			ok = ok && parse<uint64_t>(broken).ec == std::errc::invalid_argument;
+		}
+	}
+
+	for (const char* text : {"0", "-0", "1", "-1.5", "3.14159265358979", "2.718281828459045235360287",
+	                         "1e22", "1e23", "123456789012345678901234567890", "0.1", ".5", "5.", "1e-5",
+	                         "4.9e-324", "2.2250738585072014e-308", "1.7976931348623157e308",
+	                         "0.000000000000000000000000000000000000001234", "9007199254740993",
+	                         "12.5E+3", "7e-22", "1.00000000000000011102230246251565404236316680908203125"})
+		ok = ok && parses_like_strtod(text);
+	for (int i = 0; i < 2000; ++i) {
+		x = x * 1664525u + 1013904223u;
+		char text[64];
+		std::snprintf(text, sizeof(text), "%.*e", int(x % 20), double(x) * (x % 3 ? 1e-7 : 1e13));
+		ok = ok && parses_like_strtod(text);
+	}
+	ok = ok && std::isinf(parse<double>("-Infinity").value) && parse<double>("-Infinity").value < 0
+		&& std::isnan(parse<double>("nan(123)").value)
+		&& parse<double>("1e400").ec == std::errc::result_out_of_range
+		&& parse<double>("1e-400").ec == std::errc::result_out_of_range
+		&& parse<double>("e5").ec == std::errc::invalid_argument
+		&& parse<double>(".").ec == std::errc::invalid_argument
+		&& parse<double>("1e").ec == std::errc::invalid_argument
+		&& parse<double>("0x10").ec == std::errc::invalid_argument;
+
+	// Prefixes, which leave the rest of the view.
+	bev::string_view rest{"12.5 ms, -3 retries, 1e ok, 99999999999999999999, x"};
+	ok = ok && bev::consume_number<double>(rest).value == 12.5 && rest.starts_with(" ms");
+	rest.remove_prefix(5);
+	ok = ok && bev::consume_number<int>(rest).value == -3 && rest.starts_with(" retries");
+	rest.remove_prefix(10);
+	ok = ok && bev::consume_number<double>(rest).value == 1 && rest.starts_with("e ok");
+	rest.remove_prefix(6);
+	ok = ok && bev::consume_number<uint64_t>(rest).ec == std::errc::result_out_of_range && rest.starts_with(", x");
+	rest.remove_prefix(2);
+	ok = ok && bev::consume_number<int>(rest).ec == std::errc::invalid_argument && rest == "x";
+	return ok;
+}
+
+static std::string ascii_lower(const std::string& s) {
+	std::string result = s;
+	for (char& c : result)
+		if (c >= 'A' && c <= 'Z')
+			c = char(c + 32);
+	return result;
+}
+
+static int sign(int x) {
+	return (x > 0) - (x < 0);
+}
+
+static bool test_ci_string_view() {
+	using namespace bev;
+	static_assert(ci_string_view("Content-Length") == ci_string_view("content-LENGTH"));
+	static_assert(ci_string_view("Content-Length") != ci_string_view("Content-Type"));
+	static_assert(ci_string_view("ETag") < ci_string_view("expires"));
+	static_assert(ci_string_view("X-Request-Id").find("request") == 2);
+	static_assert(std::hash<ci_string_view>{}("Host") == std::hash<ci_string_view>{}("hOST"));
+	static_assert(std::hash<ci_string_view>{}("Host") == std::hash<bev::string_view>{}("host"));
+
+	// The bytes around the letters, which must not be folded, and bytes
+	// whose lower seven bits are letters.
+	const std::string alphabet = "aAzZ@[`{-_0ÁáÛ";
+	bool ok = true;
+	for (size_t len = 0; len < 100; ++len) {
+		std::string text;
+		unsigned seed = unsigned(len);
+		for (size_t i = 0; i < len; ++i) {
+			seed = seed * 1103515245u + 12345u;
+			text.push_back(alphabet[(seed >> 16) % alphabet.size()]);
+		}
+		std::string flipped = text;
+		for (char& c : flipped)
+			if ((c | 0x20) >= 'a' && (c | 0x20) <= 'z')
+				c ^= 0x20;
+		const std::string lower = ascii_lower(text);
+		const ci_string_view ci{text};
+		ok = ok && ci == ci_string_view{flipped}
+			&& std::hash<ci_string_view>{}(ci) == std::hash<ci_string_view>{}(flipped)
+			&& std::hash<ci_string_view>{}(ci) == std::hash<bev::string_view>{}(lower);
+		// Each difference in turn, compared with the lowercase strings.
+		for (size_t i = 0; i < len; ++i) {
+			std::string other = flipped;
+			other[i] = alphabet[(i + len) % alphabet.size()];
+			const int expected = sign(lower.compare(ascii_lower(other)));
+			ok = ok && sign(ci.compare(other)) == expected
+				&& (ci == ci_string_view{other}) == (expected == 0);
+		}
+		const std::string lower_flipped = ascii_lower(flipped);
+		for (const char* needle : {"a", "Z", "`", "Á", "aZ", "z@a", "{a_Z-0"}) {
+			const std::string lower_needle = ascii_lower(needle);
+			for (size_t pos : {size_t(0), len / 2}) {
+				ok = ok && ci.find(needle, pos) == lower_flipped.find(lower_needle, pos)
+					&& ci.rfind(needle) == lower_flipped.rfind(lower_needle)
+					&& ci.find_first_of(needle, pos) == lower_flipped.find_first_of(lower_needle, pos);
+			}
+		}
+	}
+
+	// Conversions in both directions keep the safederef flag.
+	const bev::string_view sv = "Accept-Encoding"_sv;
+	const ci_string_view ci = sv;
+	const bev::string_view back = ci;
+	ok = ok && ci.is_cstring() && back.is_cstring() && back.data() == sv.data()
+		&& ci.starts_with("accept-") && ci.ends_with("ENCODING") && ci.find('E') == 3
+		&& ci.substr(7) == "encoding";
+
+	std::unordered_map<ci_string_view, int> headers{{"Content-Length"_sv, 1}, {"Host"_sv, 2}};
+	const std::string host = "HOST";
+	ok = ok && headers.count("content-length") && headers.at(ci_string_view{host}) == 2
+		&& !headers.count("content-type");
+	return ok;
+}
+
+// UTF-8 validation straight from table 3-7 of the Unicode standard.
+static bool reference_utf8(const std::string& s) {
+	for (size_t i = 0; i < s.size();) {
+		const unsigned c = static_cast<unsigned char>(s[i]);
+		size_t len = 1;
+		unsigned lo = 0x80, hi = 0xbf;
+		if (c < 0x80)
+			len = 1;
+		else if (c >= 0xc2 && c <= 0xdf)
+			len = 2;
+		else if (c == 0xe0)
+			len = 3, lo = 0xa0;
+		else if (c == 0xed)
+			len = 3, hi = 0x9f;
+		else if (c >= 0xe1 && c <= 0xef)
+			len = 3;
+		else if (c == 0xf0)
+			len = 4, lo = 0x90;
+		else if (c >= 0xf1 && c <= 0xf3)
+			len = 4;
+		else if (c == 0xf4)
+			len = 4, hi = 0x8f;
+		else
+			return false;
+		if (len > 1) {
+			if (i + len > s.size())
+				return false;
+			const unsigned c1 = static_cast<unsigned char>(s[i + 1]);
+			if (c1 < lo || c1 > hi)
+				return false;
+			for (size_t j = 2; j < len; ++j)
+				if ((static_cast<unsigned char>(s[i + j]) & 0xc0) != 0x80)
+					return false;
+		}
+		i += len;
+	}
+	return true;
+}
+
+static std::string encode_utf8(char32_t cp) {
+	std::string result;
+	if (cp < 0x80) {
+		result.push_back(char(cp));
+	} else if (cp < 0x800) {
+		result.push_back(char(0xc0 | (cp >> 6)));
+		result.push_back(char(0x80 | (cp & 0x3f)));
+	} else if (cp < 0x10000) {
+		result.push_back(char(0xe0 | (cp >> 12)));
+		result.push_back(char(0x80 | ((cp >> 6) & 0x3f)));
+		result.push_back(char(0x80 | (cp & 0x3f)));
+	} else {
+		result.push_back(char(0xf0 | (cp >> 18)));
+		result.push_back(char(0x80 | ((cp >> 12) & 0x3f)));
+		result.push_back(char(0x80 | ((cp >> 6) & 0x3f)));
+		result.push_back(char(0x80 | (cp & 0x3f)));
+	}
+	return result;
+}
+
+static bool test_utf8() {
+	using namespace bev;
+	static_assert(utf8::validate("h\xc3\xa9llo \xe2\x82\xac \xf0\x9f\x98\x80"));
+	static_assert(!utf8::validate("\xc0\xaf") && !utf8::validate("\xed\xa0\x80")
+		&& !utf8::validate("\xf4\x90\x80\x80") && !utf8::validate("\xe2\x82"));
+	static_assert(utf8::is_ascii("plain") && !utf8::is_ascii("caf\xc3\xa9"));
+	static_assert(utf8::count_code_points("caf\xc3\xa9 \xe2\x82\xac") == 6);
+	static_assert(utf8::truncate_to_boundary("caf\xc3\xa9", 4) == "caf");
+
+	// Every pair of bytes after ASCII, at the end and in front of a
+	// continuation byte, at several positions within a block.
+	bool ok = true;
+	for (unsigned a = 0x80; a < 0x100; ++a) {
+		for (unsigned b = 0; b < 0x100; ++b) {
+			for (size_t pos : {size_t(0), size_t(14), size_t(15), size_t(30), size_t(31), size_t(62)}) {
+				std::string text(pos, 'x');
+				text.push_back(char(a));
+				text.push_back(char(b));
+				const std::string continued = text + "\x80" + std::string(40, 'y');
+				ok = ok && utf8::validate(text) == reference_utf8(text)
+					&& utf8::validate(continued) == reference_utf8(continued);
+			}
+		}
+	}
+
+	// Random mixtures of ASCII runs, valid sequences of all lengths and
+	// stray bytes, and the valid ones with a single corrupted byte.
+	const unsigned char stray[] = {0x80, 0x8f, 0x90, 0x9f, 0xa0, 0xbf, 0xc0, 0xc1,
+		0xc2, 0xdf, 0xe0, 0xed, 0xef, 0xf0, 0xf4, 0xf5, 0xff};
+	uint32_t seed = 1;
+	const auto next = [&seed] { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+	for (int round = 0; round < 3000; ++round) {
+		std::string text;
+		size_t code_points = 0;
+		bool exact = true;
+		const size_t target = next() % 300;
+		while (text.size() < target) {
+			const uint32_t kind = next() % 8;
+			if (kind < 2) {
+				const size_t run = next() % 40;
+				text.append(run, 'a');
+				code_points += run;
+			} else if (kind == 7 && round % 3 == 0) {
+				text.push_back(char(stray[next() % sizeof(stray)]));
+				exact = false;
+			} else {
+				char32_t cp = next() % 0x110000;
+				if (kind < 5)
+					cp %= 0x80u << (kind - 2) * 4;
+				if (cp >= 0xd800 && cp < 0xe000)
+					cp = 0xfffd;
+				text += encode_utf8(cp);
+				++code_points;
+			}
+		}
+		if (round % 2 == 1 && !text.empty()) {
+			text[next() % text.size()] = char(stray[next() % sizeof(stray)]);
+			exact = false;
+		}
+		const bool valid = reference_utf8(text);
+		ok = ok && utf8::validate(text) == valid
+			&& utf8::is_ascii(text) == std::all_of(text.begin(), text.end(),
+				[](char c) { return static_cast<unsigned char>(c) < 0x80; });
+		if (exact) {
+			std::string reencoded;
+			size_t n = 0;
+			for (char32_t cp : utf8::code_points(text)) {
+				reencoded += encode_utf8(cp);
+				++n;
+			}
+			ok = ok && valid && utf8::count_code_points(text) == code_points
+				&& n == code_points && reencoded == text;
+		}
+	}
+
+	// Invalid sequences are replaced byte by byte.
+	std::u32string decoded;
+	const std::string broken = "a\xe2\x82z\xff";
+	for (char32_t cp : utf8::code_points(broken))
+		decoded.push_back(cp);
+	ok = ok && decoded == U"a\ufffd\ufffdz\ufffd";
+
+	// Truncation never splits a sequence, and sets the safederef flag.
+	const std::string euros = "\xe2\x82\xac\xe2\x82\xac\xe2\x82\xac";
+	for (size_t max = 0; max < 12; ++max) {
+		const string_view cut = utf8::truncate_to_boundary(euros, max);
+		ok = ok && cut.size() == std::min<size_t>(max / 3 * 3, 9) && utf8::validate(cut);
+	}
+	const std::string two("\xe2\x82\xac\0\xe2\x82\xac", 7);
+	const string_view unflagged{two.data(), two.size()};
+	ok = ok && !unflagged.is_cstring() && utf8::truncate_to_boundary(unflagged, 3).is_cstring();
+	return ok;
+}
+
+static bool test_offset_view() {
+	using namespace bev;
+	static_assert(sizeof(offset_view) == 8);
+
+	const std::string arena = "delta\nalpha\ncharlie\nbravo\nalpha";
+	const bev::offset_base base{arena};
+	std::vector<offset_view> index;
+	std::vector<bev::string_view> expected;
+	for (bev::string_view term : bev::split(bev::string_view{arena}, '\n')) {
+		index.push_back(base.make(term));
+		expected.push_back(term);
+	}
+	bool ok = index.size() == 5 && index[1].offset() == 6 && index[1].size() == 5
+		&& base.view(index[2]) == "charlie" && base(index[2]).data() == arena.data() + 12;
+
+	// The safederef flag survives the round trip.
+	const bev::string_view whole{arena};
+	const bev::string_view unflagged{arena.data(), 5};
+	ok = ok && base(base.make(whole)).is_cstring()
+		&& !base(base.make(unflagged)).is_cstring() && base(base.make(whole.take(5))).is_cstring() == whole.take(5).is_cstring();
+
+	// Slicing moves the offset, and sets the flag like views do.
+	const offset_view sub = index[2].substr(1, 3);
+	offset_view suffix = base.make(unflagged);
+	suffix.remove_suffix(1);
+	ok = ok && sub.offset() == 13 && base(sub) == "har" && base(index[2].substr(4)) == "lie"
+		&& base(suffix) == "delt" && base(suffix).is_cstring() == whole.take(4).is_cstring()
+		&& offset_view{}.empty() && base(offset_view{6, 5}) == "alpha";
+
+	// Views before the arena, or longer than 31 bits, don't fit.
+	int errors = 0;
+	try { (void)bev::offset_base{arena.data() + 1}.make(whole); } catch (const std::length_error&) { ++errors; }
+	try { (void)base.make(bev::string_view{arena.data(), offset_view::max_length + 1}); } catch (const std::length_error&) { ++errors; }
+	ok = ok && errors == 2 && base.make(bev::string_view{}).empty();
+
+	// Comparisons, hashes and searches are those of the resolved views.
+	std::sort(index.begin(), index.end(), base.less());
+	std::sort(expected.begin(), expected.end());
+	for (size_t i = 0; i < index.size(); ++i)
+		ok = ok && base(index[i]) == expected[i] && base.hash(index[i]) == std::hash<bev::string_view>{}(expected[i]);
+	ok = ok && std::lower_bound(index.begin(), index.end(), "bravo"_sv, base.less()) - index.begin() == 2
+		&& base.compare(index[0], index[1]) == 0 && !index[0].same_range(index[1])
+		&& base.equal(index[0], index[1]) && base.compare(index[2], "bravo"_sv) == 0
+		&& base.compare(index[2], index[3]) < 0 && !base.equal(index[3], "charli"_sv)
+		&& base.find(index[3], "rl"_sv) == 3 && base.find(index[3], 'z') == bev::string_view::npos;
+
+	std::unordered_set<offset_view, bev::offset_base::key_hash, bev::offset_base::key_equal> unique{
+		index.begin(), index.end(), 0, base.hasher(), base.equal_to()};
+	ok = ok && unique.size() == 4 && unique.count(base.make(whole.substr(6, 5))) == 1;
+	return ok;
+}
+
+static bool test_sorted_view_set() {
+	using namespace bev;
+	const sorted_view_set empty;
+	const sorted_view_set routes = {"/api/v2/users"_sv, "/api/v1/users"_sv, "/api/v2/"_sv,
+		"/api/v2/users/0123456789"_sv, "/api/v1/users"_sv, "/api/"_sv, "/api/v2/users/0123456788"_sv};
+	const std::vector<string_view> sorted(routes.begin(), routes.end());
+	bool ok = empty.empty() && empty.begin() == empty.end() && !empty.contains(""_sv)
+		&& empty.lower_bound_prefix(""_sv) == empty.end()
+		&& routes.size() == 6 && routes.common_prefix_length() == 5 && sorted.size() == 6
+		&& std::is_sorted(sorted.begin(), sorted.end()) && sorted.front() == "/api/"
+		&& routes.contains("/api/v2/users/0123456788"_sv) && !routes.contains("/api/v2/users/0"_sv)
+		&& !routes.contains("/ap"_sv) && *routes.lower_bound("/ap"_sv) == "/api/"
+		&& routes.lower_bound("/b"_sv) == routes.end() && *routes.lower_bound("/api/v1/z"_sv) == "/api/v2/"
+		&& *routes.lower_bound_prefix("/api/v2/users/"_sv) == "/api/v2/users/0123456788"
+		&& routes.lower_bound_prefix("/api/v3"_sv) == routes.end()
+		&& *routes.lower_bound_prefix(""_sv) == "/api/" && routes.find("/api/v2/users"_sv)->is_cstring();
+
+	// Random keys from a small alphabet, with many shared prefixes and keys
+	// that differ only after the cached 8 bytes or by trailing null bytes.
+	uint32_t x = 1;
+	const auto next = [&] { x = x * 1664525u + 1013904223u; return x >> 16; };
+	for (int round = 0; round < 50; ++round) {
+		std::vector<std::string> storage;
+		const std::string common(next() % 3 * 4, 'p');
+		for (uint32_t i = 0, n = next() % 300; i < n; ++i) {
+			std::string key = common;
+			for (uint32_t j = 0, len = next() % 14; j < len; ++j)
+				key += "ab\0\xff"[next() % 4];
+			storage.push_back(key);
+		}
+		const sorted_view_set set{storage.begin(), storage.end()};
+		const std::set<string_view> reference(storage.begin(), storage.end());
+		ok = ok && set.size() == reference.size() && std::equal(set.begin(), set.end(), reference.begin());
+		for (int i = 0; i < 50; ++i) {
+			std::string query = next() % 4 ? common : std::string(next() % 8, 'p');
+			for (uint32_t j = 0, len = next() % 14; j < len; ++j)
+				query += "ab\0\xff"[next() % 4];
+			const auto expected = reference.lower_bound(query);
+			const auto found = set.lower_bound(query);
+			const bool has_prefix = expected != reference.end() && expected->starts_with(query);
+			ok = ok && (found == set.end() ? expected == reference.end() : expected != reference.end() && *found == *expected)
+				&& set.contains(query) == (reference.count(query) == 1)
+				&& (set.lower_bound_prefix(query) == set.end()) == !has_prefix;
+		}
+	}
+	return ok;
+}
+
+static bool test_output() {
+	using namespace bev;
+	const std::string storage = "key=value";
+	const string_view key = string_view{storage}.take(3);
+	std::ostringstream os;
+	os << key << '|';
+	os.width(6);
+	os << key << '|';
+	os.width(6);
+	os.fill('*');
+	os << std::left << key << '|' << key;
+	os.width(2);
+	os << key;
+	bool ok = os.str() == "key|   key|key***|keykey";
+
+	std::wostringstream wos;
+	wos.width(4);
+	wos << L"wide"_sv << L"r"_sv;
+	ok = ok && wos.str() == L"wider";
+
+	std::string out = "name: ";
+	append_to(out, key);
+	append_to(append_to(out, ", "_sv), ci_string_view{"VALUE"});
+	ok = ok && out == "name: key, VALUE";
+
+#if __has_include(<fmt/format.h>)
+	ok = ok && fmt::format("{}|{:>5}|{:.2}", key, key, ci_string_view{"Key"}) == "key|  key|Ke";
+#endif
+	return ok;
+}
+
+// Without `BEV_STRING_VIEW_STATS` all counters stay zero.
+static bool test_stats() {
+	using namespace bev;
+	using stats::counter;
+	const stats::counters before = stats::thread_snapshot();
+	const std::string storage = "key=value";
+	const string_view whole{storage};
+	const string_view unflagged{storage.data(), 3};
+	bool ok = whole.is_cstring() && !unflagged.is_cstring() && !whole.take(3).is_cstring();
+	{
+		const cstring_arg copy{unflagged};
+		std::string long_key(300, 'k');
+		const basic_cstring_arg<char, std::char_traits<char>, 64> heap{string_view{long_key.data(), 299}};
+		ok = ok && copy.copied() && heap.heap_allocated();
+	}
+	ok = ok && whole.find("val"_sv) == 4 && whole.find('v', 2) == 4 && whole.rfind('k') == 0
+		&& whole.rfind("val"_sv) == 4
+		&& whole.find_first_of(" =;"_sv) == 3 && hash<>{}(whole) == std::hash<string_view>{}(whole);
+	static_assert(hash<>{}("constant"_sv) != 0 && "constant"_sv.find('t') == 4);
+
+	const stats::counters after = stats::thread_snapshot();
+	const auto delta = [&](counter c) { return after[c] - before[c]; };
+	if constexpr (!stats::enabled)
+		return ok && delta(counter::is_cstring_true) == 0 && stats::snapshot()[counter::hash_calls] == 0;
+
+	// Both the view and the copy count as calls of `is_cstring()`.
+	ok = ok && delta(counter::is_cstring_true) == 1 && delta(counter::is_cstring_no_flag) == 3
+		&& delta(counter::is_cstring_not_null) == 1 && delta(counter::cstring_copies) == 2
+		&& delta(counter::cstring_copy_bytes) == 302 && delta(counter::cstring_heap_copies) == 1
+		&& delta(counter::find_calls) == 1 && delta(counter::find_bytes) == 9
+		&& delta(counter::find_char_calls) == 1 && delta(counter::find_char_bytes) == 7
+		&& delta(counter::rfind_calls) == 1 && delta(counter::rfind_bytes) == 9
+		&& delta(counter::rfind_char_calls) == 1 && delta(counter::rfind_char_bytes) == 9
+		&& delta(counter::find_of_calls) == 1 && delta(counter::find_of_bytes) == 9
+		&& delta(counter::hash_calls) == 2 && delta(counter::hash_bytes) == 18;
+
+	// Counters of other threads are included in `snapshot()`, also after
+	// they have exited.
+	const uint64_t total = stats::snapshot()[counter::hash_calls];
+	std::thread([] { (void)hash<>{}("thread"_sv); }).join();
+	return ok && stats::snapshot()[counter::hash_calls] == total + 1
+		&& stats::thread_snapshot()[counter::hash_calls] == after[counter::hash_calls]
+		&& std::string{stats::counter_names[size_t(counter::hash_bytes)]} == "hash_bytes";
+}
+
+#if defined(BEV_STRING_VIEW_RUNTIME_DISPATCH)
+// Runs the kernel tests once for every instruction set that is available.
+static bool test_runtime_dispatch() {
+	const bev::isa_level initial = bev::active_isa();
+	bool ok = bev::isa_supported(initial) && bev::isa_supported(bev::isa_level::scalar);
+	for (bev::isa_level level : {bev::isa_level::scalar, bev::isa_level::sse2,
+			bev::isa_level::ssse3, bev::isa_level::avx2, bev::isa_level::neon}) {
+		if (!bev::force_isa(level))
+			continue;
+		ok = ok && bev::active_isa() == level
+			&& test_find() && test_equal() && test_find_of() && test_ci_string_view() && test_utf8()
+			&& test_multi_searcher() && test_split();
+	}
+	return bev::force_isa(initial) && ok;
+}
+#endif
 
 int main() {
 	// TODO: Somehow run the existing libstdc++ string_view test suite against this class.
 	std::string foo("asdf");
 	bev::string_view sv{foo};
-	return foo == sv;
+	bool ok = foo == sv;
+	ok = ok && test_cstring_arg();
+	ok = ok && test_find();
+	ok = ok && test_equal();
+	ok = ok && test_find_of();
+	ok = ok && test_hash();
+	ok = ok && test_hashed_string_view();
+	ok = ok && test_literals();
+	ok = ok && test_static_map();
+	ok = ok && test_segmented_string_view();
+	ok = ok && test_incremental_searcher();
+	ok = ok && test_searcher();
+	ok = ok && test_multi_searcher();
+	ok = ok && test_split();
+	ok = ok && test_parallel();
+	ok = ok && test_mapped_file();
+	ok = ok && test_string_interner();
+	ok = ok && test_zstring_view();
+	ok = ok && test_cstring_batch();
+	ok = ok && test_cached_string_view();
+	ok = ok && test_slicing();
+	ok = ok && test_parse();
+	ok = ok && test_ci_string_view();
+	ok = ok && test_utf8();
+	ok = ok && test_offset_view();
+	ok = ok && test_sorted_view_set();
+	ok = ok && test_output();
+	ok = ok && test_stats();
+#if defined(BEV_STRING_VIEW_RUNTIME_DISPATCH)
+	ok = ok && test_runtime_dispatch();
+#endif
+	return ok;
 }